@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Thread pinning for --affinity. The CPU order is built from the sysfs topology of the
+// CPUs this process may run on (so an outer taskset still applies), and the main thread
+// plus the OpenMP team are pinned once, before the operands are first-touched.
+namespace affinity {
+
+enum class Policy {
+    none,    // leave placement to the OS
+    compact, // fill each core's SMT siblings, then the next core, package by package
+    scatter, // round-robin over NUMA nodes and then cores; SMT siblings come last
+    list,    // an explicit CPU list such as "0,2,4-7", in that order
+};
+
+// Parses "none", "compact", "scatter" or a CPU list (*cpus receives the list)
+bool parse_policy(const std::string &spec, Policy *policy, std::vector<int> *cpus);
+const char* policy_name(Policy p);
+
+// The CPU of each of num_threads threads (thread t gets (*cpus)[t]). With no_smt only one
+// hardware thread per core is used. Threads wrap around when there are fewer CPUs than
+// threads (*shared is set). Returns false with *error for an empty or unusable set.
+bool plan(Policy policy, const std::vector<int> &list, bool no_smt, int num_threads,
+          std::vector<int> *cpus, bool *shared, std::string *error);
+
+// Pins the calling (main) thread and the OpenMP team of num_threads threads to cpus[t]. libgomp
+// keeps team position t on the same pool thread for later regions of that size.
+bool pin_threads(const std::vector<int> &cpus, int num_threads);
+
+// CPU each of num_threads OpenMP threads runs on right now (sched_getcpu)
+std::vector<int> current_cpus(int num_threads);
+
+// "0,1,2" for the AFFINITY line and the run report
+std::string format_cpus(const std::vector<int> &cpus);
+
+} // namespace affinity
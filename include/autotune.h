@@ -0,0 +1,29 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "gemm_dims.h"
+#include <string>
+
+// Best (mode, BS) found for one problem shape on this host
+struct TunedConfig {
+    std::string mode;
+    int BS = 0;
+    double seconds = 0.0;
+};
+
+// Times the candidate block / panel-packed modes (BS sweep first, then the hybrid and
+// interleaved tuning grid at their best BS) on A x B and returns the fastest in *best.
+// C is used as scratch and left zeroed. Each candidate is logged as a TUNE line on stderr.
+bool autotune_search(const double *A, const double *B, double *C, const GemmDims &d,
+                     int num_threads, TunedConfig *best);
+
+// Per-host tuning file in the working directory: tuning_<hostname>.tsv
+std::string default_tuning_file();
+
+// Looks up the entry for (M, N, K, isa, threads); returns false if the file or entry is missing
+bool load_tuned_config(const std::string &path, const GemmDims &d, IsaLevel isa, int num_threads,
+                       TunedConfig *cfg);
+
+// Adds or replaces the entry for (M, N, K, isa, threads); returns false on I/O errors
+bool save_tuned_config(const std::string &path, const GemmDims &d, IsaLevel isa, int num_threads,
+                       const TunedConfig &cfg);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+// Wall-time statistics over the timed repeats of one configuration
+struct TimingStats {
+    int count = 0;
+    double min = 0.0, median = 0.0, p95 = 0.0, mean = 0.0, stddev = 0.0;
+};
+
+// Median interpolates between the two middle samples; p95 is the nearest-rank percentile and
+// stddev is the sample standard deviation (0 for a single sample).
+TimingStats compute_timing_stats(std::vector<double> samples);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+// Instruction-set tiers the block kernels are built for, ordered from least to most capable
+// (avx512_bf16 adds the AVX512_BF16 dot products used by --dtype bf16)
+enum class IsaLevel { scalar = 0, avx2 = 1, avx512 = 2, avx512_bf16 = 3 };
+
+// One implementation of a kernel mode for a given instruction-set tier
+template <typename Fn>
+struct IsaVariant {
+    IsaLevel isa;
+    Fn fn;
+};
+
+// Best tier supported by this CPU and OS (cpuid + xgetbv, evaluated once at startup)
+IsaLevel detect_isa();
+
+// Caps dispatch at the given tier (used by --isa); the default is no cap
+void set_isa_limit(IsaLevel limit);
+
+// min(detect_isa(), limit): the tier the dispatchers select kernels for
+IsaLevel effective_isa();
+
+const char* isa_name(IsaLevel isa);
+
+// Parses "scalar", "avx2", "avx512" or "avx512_bf16"; returns false for anything else
+bool parse_isa(const std::string& name, IsaLevel *out);
+
+// Picks the first variant (listed best first) that the effective tier can run
+template <typename Fn, typename Container>
+Fn select_isa_variant(const Container& variants, IsaLevel *chosen) {
+    IsaLevel best = effective_isa();
+    for (const auto& v : variants) {
+        if (v.isa <= best) {
+            if (chosen) *chosen = v.isa;
+            return v.fn;
+        }
+    }
+    return nullptr;
+}
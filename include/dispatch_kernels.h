@@ -1,7 +1,14 @@
 #pragma once
 
+#include "cpu_features.h"
 #include "kernels.h"
 #include <string>
 
-matmul_func_t get_kernel_for_mode(const std::string& mode);
+// Returns the best variant of the mode for effective_isa() (nullptr if the mode is unknown).
+// If chosen is non-null it receives the instruction-set tier of the returned variant.
+matmul_func_t get_kernel_for_mode(const std::string& mode, IsaLevel *chosen = nullptr);
 
+// Same lookup for the --dtype f32 and bf16 block kernels; only "avx" and "scalar" have
+// reduced-precision variants (the bf16 "avx" variant needs AVX512_BF16).
+matmul_f32_func_t get_kernel_for_mode_f32(const std::string& mode, IsaLevel *chosen = nullptr);
+matmul_bf16_func_t get_kernel_for_mode_bf16(const std::string& mode, IsaLevel *chosen = nullptr);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "kernels_packed.h"
+#include <string>
+
+matmul_packed_func_t get_kernel_for_mode_packed(const std::string& mode, IsaLevel *chosen = nullptr);
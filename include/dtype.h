@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Element types of the block path (--dtype). f64 is the historical double path; f32 stores
+// A, B and C as float; bf16 packs A and B as bfloat16 and accumulates into a float C.
+enum class Dtype { f64, f32, bf16 };
+
+inline bool parse_dtype(const std::string &name, Dtype *out) {
+    if (name == "f64") { *out = Dtype::f64; return true; }
+    if (name == "f32") { *out = Dtype::f32; return true; }
+    if (name == "bf16") { *out = Dtype::bf16; return true; }
+    return false;
+}
+
+inline const char* dtype_name(Dtype t) {
+    switch (t) {
+        case Dtype::f64: return "f64";
+        case Dtype::f32: return "f32";
+        case Dtype::bf16: return "bf16";
+    }
+    return "unknown";
+}
+
+// bfloat16: the upper half of an IEEE float (8 exponent bits, 7 mantissa bits)
+struct bf16_t {
+    uint16_t bits;
+};
+
+// Round to nearest even; NaNs stay (quiet) NaNs
+inline bf16_t float_to_bf16(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffffu) > 0x7f800000u) return bf16_t{uint16_t((u >> 16) | 0x40)};
+    u += 0x7fffu + ((u >> 16) & 1u);
+    return bf16_t{uint16_t(u >> 16)};
+}
+
+inline float bf16_to_float(bf16_t h) {
+    uint32_t u = uint32_t(h.bits) << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
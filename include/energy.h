@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RAPL energy counters read through the Linux powercap interface (/sys/class/powercap),
+// sampled by main() around the timed repeats only. The counters are package-wide, so
+// anything else running on the package is included; pin the run (--affinity) on a quiet host.
+namespace energy {
+
+struct Domain {
+    std::string name;      // "package-0", or "package-0/dram" for a package's DRAM subzone
+    std::string file;      // its energy_uj counter
+    uint64_t max_uj = 0;   // counter range: the value wraps to 0 past it
+    bool dram = false;
+};
+
+// Finds the package zones and their DRAM subzones (psys and the core/uncore subzones are
+// skipped, since the package total already contains them). Returns false with *error set
+// when there are none or their counters are not readable (root only since Linux 5.10).
+bool discover(std::vector<Domain> *domains, std::string *error);
+
+// The counters advance about once per millisecond; below this interval that step is over 1% of the reading
+constexpr double MIN_RELIABLE_SECONDS = 0.1;
+
+// Current counter of every domain, in microjoules
+bool read_uj(const std::vector<Domain> &domains, std::vector<uint64_t> *uj);
+
+struct Energy {
+    double package_joules = 0.0;
+    double dram_joules = 0.0;
+    bool have_dram = false;
+};
+
+// Energy between two reads. Each counter may wrap at most once in between, which at
+// package power takes hours for the usual 2^32 - 2^38 uJ ranges.
+Energy consumed(const std::vector<Domain> &domains, const std::vector<uint64_t> &before,
+                const std::vector<uint64_t> &after);
+
+// "package-0,package-0/dram" for the ENERGY line
+std::string format_domains(const std::vector<Domain> &domains);
+
+} // namespace energy
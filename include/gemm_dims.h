@@ -0,0 +1,15 @@
+#pragma once
+
+// Row-major GEMM problem C[M x N] (+)= A[M x K] * B[K x N] with explicit leading dimensions
+struct GemmDims {
+    int M = 0, N = 0, K = 0;
+    int lda = 0, ldb = 0, ldc = 0;
+};
+
+// Dimensions for tightly packed (ld = row length) A, B and C
+inline GemmDims make_gemm_dims(int M, int N, int K) {
+    GemmDims d;
+    d.M = M; d.N = N; d.K = K;
+    d.lda = K; d.ldb = N; d.ldc = N;
+    return d;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <type_traits>
+
+// Tuning grid for the hybrid and interleaved kernels. Every (AVX ops, scalar ops) pair
+// listed here is instantiated once per ISA and registered as e.g. "interleaved<2,8>",
+// so a single build covers a whole sweep. X(a, s) is invoked once per pair.
+#define KERNEL_TUNING_ROW(X, a) X(a, 1) X(a, 2) X(a, 4) X(a, 8) X(a, 16)
+#define KERNEL_TUNING_GRID(X) \
+    KERNEL_TUNING_ROW(X, 1) KERNEL_TUNING_ROW(X, 2) KERNEL_TUNING_ROW(X, 3) KERNEL_TUNING_ROW(X, 4)
+
+// hybrid also runs purely vector or purely scalar chunks
+#define HYBRID_TUNING_GRID(X) KERNEL_TUNING_GRID(X) X(1, 0) X(0, 8)
+#define INTERLEAVED_TUNING_GRID(X) KERNEL_TUNING_GRID(X)
+
+// Block sizes that get a fully specialised instantiation (constant-trip inner loops).
+// Any other BS, and the partial edge blocks, use the runtime-bounds instantiation (BS = 0).
+// hybrid only gets the runtime one: its scalar columns are FMA-latency bound and the
+// constant-trip versions measured 10-25% slower at BS=64.
+#define INTERLEAVED_GRID_BLOCK_SIZES 32, 64, 128
+#define HYBRID_GRID_BLOCK_SIZES 0
+
+// Calls body(std::integral_constant<int, BS>) for the listed BS equal to bs, or with
+// BS = 0 (runtime bounds) when none matches.
+template <int First, int... Rest, typename F>
+inline void with_block_size(int bs, F &&body) {
+    if (bs == First) {
+        body(std::integral_constant<int, First>{});
+    } else if constexpr (sizeof...(Rest) > 0) {
+        with_block_size<Rest...>(bs, body);
+    } else {
+        body(std::integral_constant<int, 0>{});
+    }
+}
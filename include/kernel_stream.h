@@ -0,0 +1,68 @@
+#pragma once
+
+#include <immintrin.h>
+#include <cstdint>
+
+// Memory-hint knobs of the *_pf / *_nt AVX-512 block kernels (include only from AVX-512
+// translation units). Built with `make KERNEL_PF_B_DIST=16 KERNEL_PF_C_NEXT=0` etc.
+
+// How many packB rows (k steps) ahead of the FMA loop to prefetch into L1; 0 disables it
+#ifndef KERNEL_PF_B_DIST
+#define KERNEL_PF_B_DIST 8
+#endif
+
+// 1: while a C row segment is updated, prefetch the same segment of the next tile along
+// j (the block runners' next kernel call) into L2
+#ifndef KERNEL_PF_C_NEXT
+#define KERNEL_PF_C_NEXT 1
+#endif
+
+static_assert(KERNEL_PF_B_DIST >= 0, "KERNEL_PF_B_DIST must be non-negative");
+
+// Prefetches never fault, so the row kk + KERNEL_PF_B_DIST may lie past the block
+static inline void prefetch_packB_row(const double *brow, int bs) {
+    if (KERNEL_PF_B_DIST > 0) {
+        _mm_prefetch(reinterpret_cast<const char *>(brow + KERNEL_PF_B_DIST * bs), _MM_HINT_T0);
+    }
+}
+
+static inline void prefetch_next_c_tile(const double *c_row, int j0, int j_off, int bs, int N) {
+    if (KERNEL_PF_C_NEXT && j0 + bs + j_off < N) {
+        _mm_prefetch(reinterpret_cast<const char *>(c_row + j0 + bs + j_off), _MM_HINT_T1);
+    }
+}
+
+// On the final k-panel a C tile is written for the last time, so its full 64-byte lines are
+// streamed past the caches instead of displacing A/B data. Unaligned lines (ldc or j0 not a
+// multiple of 8 doubles) keep the regular store.
+// "Final" is from the kernel's view: a morton or strassen leaf sees its whole sub-product as
+// one k-panel although that C tile is accumulated or combined again, so main rejects the
+// *_nt modes as leaves.
+static inline bool is_line_aligned(const double *p) {
+    return (reinterpret_cast<uintptr_t>(p) & 63) == 0;
+}
+
+static inline void store_c_full(double *p, __m512d v, bool stream) {
+    if (stream && is_line_aligned(p)) {
+        _mm512_stream_pd(p, v);
+    } else {
+        _mm512_storeu_pd(p, v);
+    }
+}
+
+// Row segments up to this many doubles are staged on the stack by interleaved_nt
+constexpr int STREAM_STAGE_MAX = 512;
+
+// Final write of n doubles from src to dst: the head up to dst's first 64-byte line boundary
+// and the partial tail use regular stores, and every full line in between is streamed, so the
+// stream covers the row whatever the alignment of ldc and j0.
+static inline void stream_row(double *dst, const double *src, int n) {
+    const int head = int(((64 - (reinterpret_cast<uintptr_t>(dst) & 63)) & 63) / sizeof(double));
+    int j = 0;
+    for (; j < head && j < n; ++j) dst[j] = src[j];
+    for (; j + 8 <= n; j += 8) _mm512_stream_pd(dst + j, _mm512_loadu_pd(src + j));
+    if (j < n) {
+        const __mmask8 mask = (__mmask8)((1u << (n - j)) - 1);
+        _mm512_mask_storeu_pd(dst + j, mask, _mm512_maskz_loadu_pd(mask, src + j));
+    }
+}
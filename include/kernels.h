@@ -1,17 +1,70 @@
 #pragma once
 
-// Define a function pointer type for all matmul kernels
-using matmul_func_t = void (*)(const double *packA, const double *packB, double *C,
-                              int N, int i0, int j0, int k0, int bs);
+#include "dtype.h"
+#include "kernel_grid.h"
+
+// Define a function pointer type for all matmul kernels.
+// The problem is C[M x N] += A[M x K] * B[K x N] with C row-major of leading dimension ldc.
+// Each call updates the block of C at (i0, j0) over the k-block at k0. Edge blocks are
+// partial: kernels only touch min(bs, M - i0) rows, min(bs, N - j0) columns and
+// min(bs, K - k0) k-steps. Packed blocks keep a leading dimension of bs.
+// T is the C element type and P the packed A/B element type (double for the classic kernels).
+template <typename T, typename P = T>
+using matmul_kernel_t = void (*)(const P *packA, const P *packB, T *C,
+                                 int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+using matmul_func_t = matmul_kernel_t<double>;
 
 // Declare all kernel functions
 extern "C" void kernel_avx(const double *packA, const double *packB, double *C,
-                           int N, int i0, int j0, int k0, int bs);
+                           int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_avx_tile(const double *packA, const double *packB, double *C,
+                                int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
 extern "C" void kernel_scalar(const double *packA, const double *packB, double *C,
-                              int N, int i0, int j0, int k0, int bs);
-extern "C" void kernel_hybrid(const double *packA, const double *packB, double *C,
-                              int N, int i0, int j0, int k0, int bs);
-extern "C" void kernel_interleaved(const double *packA, const double *packB, double *C,
-                                   int N, int i0, int j0, int k0, int bs);
+                              int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+
+// AVX2/FMA3 variants, picked by the dispatcher on hosts without AVX-512
+extern "C" void kernel_avx_avx2(const double *packA, const double *packB, double *C,
+                                int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_avx_tile_avx2(const double *packA, const double *packB, double *C,
+                                     int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+
+// hybrid / interleaved instantiations, one per (AVX ops, scalar ops) pair of kernel_grid.h,
+// named kernel_<family>[_avx2]_<avx ops>_<scalar ops>
+#define DECLARE_GRID_KERNEL(name) \
+    extern "C" void name(const double *packA, const double *packB, double *C, \
+                         int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+#define DECLARE_KERNEL_HYBRID(a, s) \
+    DECLARE_GRID_KERNEL(kernel_hybrid_##a##_##s) DECLARE_GRID_KERNEL(kernel_hybrid_avx2_##a##_##s)
+#define DECLARE_KERNEL_INTERLEAVED(a, s) \
+    DECLARE_GRID_KERNEL(kernel_interleaved_##a##_##s) DECLARE_GRID_KERNEL(kernel_interleaved_avx2_##a##_##s)
+HYBRID_TUNING_GRID(DECLARE_KERNEL_HYBRID)
+INTERLEAVED_TUNING_GRID(DECLARE_KERNEL_INTERLEAVED)
+
+// Memory-hint variants (kernel_stream.h): _pf prefetches the next packB rows and C tile,
+// _nt also streams C with non-temporal stores on the final k-panel
+extern "C" void kernel_avx_pf(const double *packA, const double *packB, double *C,
+                              int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_avx_nt(const double *packA, const double *packB, double *C,
+                              int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_interleaved_pf(const double *packA, const double *packB, double *C,
+                                      int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_interleaved_nt(const double *packA, const double *packB, double *C,
+                                      int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+
 extern "C" void kernel_blas(const double *packA, const double *packB, double *C,
-                           int N, int i0, int j0, int k0, int bs);
+                           int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+
+// Reduced-precision block kernels (--dtype). f32 keeps the packA/packB layouts above.
+// bf16 packs A as above (rows zero-padded to an even k depth) and stores B as k pairs,
+// packB[(kk/2)*2*bs + 2*jj + (kk&1)], the operand layout of vdpbf16ps; C is float.
+using matmul_f32_func_t = matmul_kernel_t<float>;
+using matmul_bf16_func_t = matmul_kernel_t<float, bf16_t>;
+
+extern "C" void kernel_scalar_f32(const float *packA, const float *packB, float *C,
+                                  int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_avx_f32(const float *packA, const float *packB, float *C,
+                               int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_scalar_bf16(const bf16_t *packA, const bf16_t *packB, float *C,
+                                   int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_avx_bf16(const bf16_t *packA, const bf16_t *packB, float *C,
+                                int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
@@ -0,0 +1,19 @@
+#pragma once
+
+// Sliver geometry shared by the panel-major packers and the kernels that read them.
+constexpr int PACK_MR = 8;  // rows per A sliver
+constexpr int PACK_NR = 24; // columns per B sliver
+
+// Function pointer type for kernels that consume panel-major packed blocks:
+//   packA: MR-row slivers. The sliver starting at row ii (h = min(MR, bs-ii) rows) lives at
+//          packA + ii*bs and is stored column-interleaved: sliver[kk*h + r].
+//   packB: NR-column slivers. The sliver starting at column jj (w = min(NR, bs-jj) columns)
+//          lives at packB + jj*bs and is stored row-interleaved: sliver[kk*w + c].
+// At the matrix edge h, w and the k depth shrink to the valid part of the block (see kernels.h).
+using matmul_packed_func_t = void (*)(const double *packA, const double *packB, double *C,
+                                     int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+
+extern "C" void kernel_avx_packed(const double *packA, const double *packB, double *C,
+                                  int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
+extern "C" void kernel_scalar_packed(const double *packA, const double *packB, double *C,
+                                     int M, int N, int K, int ldc, int i0, int j0, int k0, int bs);
@@ -1,9 +1,19 @@
 #pragma once
 
-// Define a function pointer type for whole-matrix kernels
-using matmul_whole_func_t = void (*)(const double *A, const double *B, double *C, int N);
+// Define a function pointer type for whole-matrix kernels:
+// C[M x N] = A[M x K] * B[K x N], all row-major with leading dimensions lda/ldb/ldc.
+using matmul_whole_func_t = void (*)(const double *A, const double *B, double *C,
+                                    int M, int N, int K, int lda, int ldb, int ldc);
 
 // Declare the new whole-matrix kernel functions
-extern "C" void kernel_scalar_whole(const double *A, const double *B, double *C, int N);
-extern "C" void kernel_blas_whole(const double *A, const double *B, double *C, int N);
+extern "C" void kernel_scalar_whole(const double *A, const double *B, double *C,
+                                    int M, int N, int K, int lda, int ldb, int ldc);
+extern "C" void kernel_blas_whole(const double *A, const double *B, double *C,
+                                  int M, int N, int K, int lda, int ldb, int ldc);
+// Strassen-Winograd recursion over a leaf kernel; configured through strassen.h
+extern "C" void kernel_strassen_whole(const double *A, const double *B, double *C,
+                                      int M, int N, int K, int lda, int ldb, int ldc);
+// Cache-oblivious recursion over Z-order tiles with a block-kernel leaf; see morton.h
+extern "C" void kernel_morton_whole(const double *A, const double *B, double *C,
+                                    int M, int N, int K, int lda, int ldb, int ldc);
 
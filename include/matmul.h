@@ -0,0 +1,166 @@
+#ifndef MATMUL_H
+#define MATMUL_H
+
+/*
+ * Stable C API of libmatmul (lib/libmatmul.a, lib/libmatmul.so): the benchmark's kernels
+ * and runners without the CLI, for long-lived callers that run many products in one
+ * process; the matmul_mixed CLI is built on it. A context holds the selected kernel, its
+ * block size, runner and thread count, its scheduling state and the results of its last
+ * products. Contexts are not thread-safe (but different contexts may run concurrently); only
+ * the ISA cap and the PAPI event set are process-wide.
+ *
+ * Matrices are row-major with explicit leading dimensions (in elements): doubles, or
+ * floats for the f32 and bf16 element types of matmul_gemm.
+ *
+ * A call that fails leaves a one-line description in matmul_last_error.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define MATMUL_API __attribute__((visibility("default")))
+#else
+#define MATMUL_API
+#endif
+
+/* Bumped on incompatible changes; also the major version of the shared library */
+#define MATMUL_API_VERSION 1
+
+typedef struct matmul_ctx matmul_ctx;
+
+typedef enum {
+    MATMUL_OK = 0,
+    MATMUL_ERR_ARG,         /* null pointer, non-positive size or too small leading dimension */
+    MATMUL_ERR_MODE,        /* unknown mode, or one this context cannot run (see matmul_select) */
+    MATMUL_ERR_NO_KERNEL,   /* matmul_dgemm before a successful matmul_select */
+    MATMUL_ERR_ALLOC,       /* packing or recursion workspace could not be allocated */
+    MATMUL_ERR_UNSUPPORTED, /* the CPU lacks the requested instruction set */
+    MATMUL_ERR_COUNTERS,    /* counters requested but PAPI could not be initialised */
+} matmul_status;
+
+MATMUL_API int matmul_api_version(void);
+MATMUL_API const char *matmul_status_string(matmul_status status);
+
+/* Caps kernel selection at "scalar", "avx2", "avx512" or "avx512_bf16" (NULL or "auto":
+ * no cap). Applies to later matmul_select calls of every context. */
+MATMUL_API matmul_status matmul_limit_isa(const char *isa);
+
+/* Flags of matmul_create's counters argument */
+#define MATMUL_COUNTERS        1 /* measure products with the PAPI events */
+#define MATMUL_COUNTERS_REPORT 2 /* also print the [papito] messages and PAPITO_* lines on stderr */
+
+/* num_threads >= 1 OpenMP threads per product. With MATMUL_COUNTERS every matmul_gemm is
+ * measured with the PAPI events of counters.in (or $PAPITO_COUNTERS). If PAPI cannot be
+ * initialised no context is created and MATMUL_ERR_COUNTERS is returned; events that are
+ * merely unavailable are skipped. Destroying the last counting context releases PAPI. */
+MATMUL_API matmul_status matmul_create(int num_threads, int counters, matmul_ctx **out);
+MATMUL_API void matmul_destroy(matmul_ctx *ctx);
+
+/* Description of the last failed call on ctx ("" after a successful one) */
+MATMUL_API const char *matmul_last_error(const matmul_ctx *ctx);
+
+/* The matmul_set_* calls below configure the next matmul_select */
+
+/* Element type of matmul_gemm: "f64" (default), "f32", or "bf16" (float A, B and C; A and
+ * B are rounded to bfloat16 while packing). f32 and bf16 run the avx and scalar block modes
+ * with the block runner. */
+MATMUL_API matmul_status matmul_set_dtype(matmul_ctx *ctx, const char *dtype);
+
+/* Runner of the block modes: "block" (default), "bpanel" (each B k-panel packed once) or
+ * "goto" (five-loop MC/KC/NC blocking; a 0 size is derived from the cache sizes for each
+ * shape). bpanel and goto are single-threaded and only run batches of one. */
+MATMUL_API matmul_status matmul_set_runner(matmul_ctx *ctx, const char *runner, int mc, int kc, int nc);
+
+/* Strassen mode: Winograd levels while min(M, N, K) > cutoff, at most max_levels deep; the
+ * leaf is "blas_whole" (default, also for NULL) or a block mode run with bs */
+MATMUL_API matmul_status matmul_set_strassen(matmul_ctx *ctx, int cutoff, int max_levels, const char *leaf);
+
+/* Morton mode: block mode computing each bs x bs tile product (default "avx") */
+MATMUL_API matmul_status matmul_set_morton_leaf(matmul_ctx *ctx, const char *leaf);
+
+/* Selects a kernel by its CLI mode name ("avx", "hybrid<2,8>", "interleaved_nt",
+ * "avx_packed", "blas_whole", "strassen", "morton", ...) with block size bs; whole-matrix
+ * modes other than morton and a block-leaf strassen ignore bs. Panel-packed modes need
+ * num_threads == 1. The *_nt modes cannot be strassen or morton leaves. The strassen and
+ * morton settings are copied into the context here; later set calls need a new select. */
+MATMUL_API matmul_status matmul_select(matmul_ctx *ctx, const char *mode, int bs);
+
+/* Tile distribution of the multithreaded block runner: "static" (default) or "steal".
+ * steal needs a block mode, num_threads > 1, the block runner and batches of one. */
+MATMUL_API matmul_status matmul_set_schedule(matmul_ctx *ctx, const char *schedule);
+
+/* Tier of the selected kernel ("avx512", ...; "generic" for whole-matrix modes), or NULL */
+MATMUL_API const char *matmul_selected_isa(const matmul_ctx *ctx);
+
+/* Runner the selected kernel uses: "whole", "packed", "block", "bpanel" or "goto" */
+MATMUL_API const char *matmul_selected_runner(const matmul_ctx *ctx);
+
+/* MC, KC and NC the goto runner uses for this shape (also checks they are positive
+ * multiples of bs) */
+MATMUL_API matmul_status matmul_runner_blocking(matmul_ctx *ctx, int M, int N, int K,
+                                                int *mc, int *kc, int *nc);
+
+/* Grows the workspace of the selected kernel for batch products of this shape and, with
+ * counters, creates the per-thread event sets, so later matmul_gemm calls of at most this
+ * size do not allocate. matmul_gemm reserves on its own; this only moves the cost. */
+MATMUL_API matmul_status matmul_reserve(matmul_ctx *ctx, int M, int N, int K, int batch);
+
+/* Flags of matmul_gemm_desc */
+#define MATMUL_C_ZEROED 1 /* C already holds zeros: the block runners skip clearing it */
+
+/* batch products C_b = A_b * B_b, entry b starting b * stride_* elements after A, B and C
+ * (strides are ignored for batch == 1). Elements are double for f64 and float otherwise. */
+typedef struct {
+    int M, N, K;
+    const void *A; int lda; long long stride_a;
+    const void *B; int ldb; long long stride_b;
+    void *C; int ldc; long long stride_c;
+    int batch;
+    int flags;
+} matmul_gemm_desc;
+
+/* Runs desc with the selected kernel; every C is overwritten */
+MATMUL_API matmul_status matmul_gemm(matmul_ctx *ctx, const matmul_gemm_desc *desc);
+
+/* C[M x N] = A[M x K] * B[K x N] in f64: matmul_gemm with a batch of one */
+MATMUL_API matmul_status matmul_dgemm(matmul_ctx *ctx, int M, int N, int K,
+                                      const double *A, int lda, const double *B, int ldb,
+                                      double *C, int ldc);
+
+/* Wall time of the last matmul_gemm, in seconds (clearing C is not included) */
+MATMUL_API double matmul_last_seconds(const matmul_ctx *ctx);
+
+/* Pack and kernel time of the bpanel and goto runners, summed over the matmul_gemm calls
+ * since the last matmul_reset_stats (MATMUL_ERR_MODE for other runners) */
+MATMUL_API matmul_status matmul_phase_seconds(const matmul_ctx *ctx, double *pack_s, double *kernel_s);
+
+/* Tile distribution of the multithreaded block runner over the calls since the last
+ * matmul_reset_stats: tiles per task, tasks per call and threads (MATMUL_ERR_MODE if no
+ * such call ran), then per thread its busy time and tile and steal counts (summed) */
+MATMUL_API matmul_status matmul_schedule_stats(const matmul_ctx *ctx, int *task_tiles, long *tasks,
+                                               int *threads);
+MATMUL_API matmul_status matmul_schedule_thread(const matmul_ctx *ctx, int thread, double *busy_s,
+                                                long *tiles, long *steals);
+MATMUL_API void matmul_reset_stats(matmul_ctx *ctx);
+
+/* Packing-buffer growths of the process so far (stays put once the workspace fits) */
+MATMUL_API long matmul_workspace_growths(void);
+
+/* Counter session: the matmul_gemm calls between begin and end are measured as one
+ * interval instead of one each (needs counters) */
+MATMUL_API matmul_status matmul_counters_begin(matmul_ctx *ctx);
+MATMUL_API matmul_status matmul_counters_end(matmul_ctx *ctx);
+
+/* PAPI counters of the last measured matmul_gemm or session (none without counters, or if
+ * no event could be added). Names stay valid until the next measurement on this context. */
+MATMUL_API int matmul_counter_count(const matmul_ctx *ctx);
+MATMUL_API const char *matmul_counter_name(const matmul_ctx *ctx, int i);
+MATMUL_API long long matmul_counter_value(const matmul_ctx *ctx, int i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MATMUL_H */
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Binary matrix file: a 64-byte header followed by `batch` row-major rows x cols blocks
+// stored back to back (ld = cols). All fields are little-endian; the payload starts at
+// byte 64, so a page-aligned mapping gives 64-byte aligned data.
+namespace matrix_io {
+
+constexpr char MAGIC[8] = {'G', 'E', 'M', 'M', 'M', 'A', 'T', '\0'};
+constexpr uint32_t VERSION = 1;
+
+enum class Dtype : uint32_t { f64 = 1 };
+enum class Layout : uint32_t { row_major = 0, col_major = 1 };
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;  // Dtype
+    uint32_t layout; // Layout
+    uint32_t batch;
+    uint64_t rows;
+    uint64_t cols;
+    uint8_t reserved[24];
+};
+static_assert(sizeof(Header) == 64, "matrix file header must stay 64 bytes");
+
+// A file mapped copy-on-write: reads come straight from the page cache, and writes (if
+// any) stay private to the process
+struct MappedMatrix {
+    double *data = nullptr;
+    int rows = 0, cols = 0, batch = 0;
+    void *base = nullptr;
+    size_t length = 0;
+};
+
+// Maps path and validates its header (f64, row-major, size matches). Pages are populated
+// up front so the timed runs do not take file faults. On failure *error says why.
+bool map_matrix(const std::string &path, MappedMatrix *out, std::string *error);
+
+void unmap_matrix(MappedMatrix *m);
+
+// Writes batch row-major rows x cols blocks (ld = cols) with a header, streaming the
+// payload in large chunks
+bool write_matrix(const std::string &path, const double *data, int rows, int cols, int batch,
+                  std::string *error);
+
+} // namespace matrix_io
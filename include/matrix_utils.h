@@ -1,12 +1,59 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
 namespace matrix_utils {
 
 // Allocates an N x N matrix with 64-byte alignment suitable for AVX512
 double* alloc(int N);
 
-// Fills an N x N matrix with random double-precision values
-void fill(double *matrix, int N);
+// Allocates a rows x cols matrix with the same 64-byte alignment
+double* alloc(int rows, int cols);
 
-} // namespace matrix_utils
+// Page backing for the large operand matrices (see alloc_matrix)
+enum class PagePolicy {
+    aligned, // posix_memalign, 4 KiB pages
+    thp,     // 2 MiB-aligned and madvise(MADV_HUGEPAGE): transparent huge pages
+    huge2m,  // mmap(MAP_HUGETLB) from the 2 MiB hugetlbfs pool
+    huge1g,  // mmap(MAP_HUGETLB) from the 1 GiB hugetlbfs pool
+};
+
+// NUMA placement for the large operand matrices
+enum class NumaPolicy {
+    none,       // kernel default (first touch)
+    local,      // bind to the node of the touching thread; pages are touched in parallel
+    interleave, // round-robin over all online nodes
+};
+
+bool parse_page_policy(const std::string &name, PagePolicy *out);
+bool parse_numa_policy(const std::string &name, NumaPolicy *out);
+const char* page_policy_name(PagePolicy p);
+const char* numa_policy_name(NumaPolicy p);
+
+// Allocates a rows x cols operand matrix with the given policies and first-touches it
+// (zeroed) with num_threads threads, so local placement follows the static OpenMP split.
+// With zero = false the first touch is left to the caller (e.g. fill with the same thread
+// count). hugetlbfs requests fall back to thp when the pool is empty; *granted (optional)
+// reports the page policy actually used. Release with matrix_utils::release.
+double* alloc_matrix(size_t rows, int cols, PagePolicy pages, NumaPolicy numa, int num_threads,
+                     PagePolicy *granted = nullptr, bool zero = true);
 
+// Frees memory from alloc_matrix (or alloc)
+void release(double *p);
+
+// Fills count doubles with integers in [1, 100] hashed from (seed, stream, index), so the
+// data is reproducible for a seed whatever the thread count, and products stay exact in
+// double. Different streams (e.g. A and B) get independent values. Runs on num_threads
+// threads with the static split of alloc_matrix, so it can serve as the first touch;
+// the inner loop is vectorised for the best ISA of the host.
+void fill(double *matrix, size_t count, uint32_t seed, uint32_t stream, int num_threads);
+
+// Sum of count values by pairwise summation over fixed 4096-element blocks, the blocks
+// spread over num_threads threads. The association order only depends on count, so the
+// result is bit-identical for any thread count.
+double checksum(const double *values, size_t count, int num_threads);
+double checksum(const float *values, size_t count, int num_threads);
+
+} // namespace matrix_utils
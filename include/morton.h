@@ -0,0 +1,36 @@
+#pragma once
+
+#include "gemm_dims.h"
+#include "kernels.h"
+
+// Cache-oblivious "morton" whole-matrix mode (morton_gemm; matmul_select keeps a MortonConfig
+// per context). A, B and C are copied into leaf_bs x leaf_bs tiles stored in Z (Morton)
+// order, and the product recurses by halving the largest of the three tile extents until
+// one tile triple is left, which goes to the leaf block kernel. Every level of the
+// recursion works on a contiguous half or quadrant of the tile arrays, so each cache level
+// finds a fitting block without a BS tuned for it; leaf_bs only has to suit the leaf
+// kernel's registers and L1. Only real tiles are stored (densely, in Z order); padded ones
+// are skipped and take no space.
+struct MortonConfig {
+    matmul_func_t leaf = nullptr; // block kernel for one tile product (required)
+    int leaf_bs = 64;             // tile edge in elements
+};
+
+// C = A * B (row-major, C overwritten) under cfg; without a leaf it is kernel_blas_whole
+void morton_gemm(const MortonConfig &cfg, const double *A, const double *B, double *C,
+                 int M, int N, int K, int lda, int ldb, int ldc);
+
+// Tile grid of one matrix: the real tile counts and their powers-of-two padding
+struct MortonGrid {
+    int mt = 0, nt = 0, kt = 0;       // tiles along M, N and K
+    int mt_pad = 0, nt_pad = 0, kt_pad = 0;
+};
+
+MortonGrid morton_grid(const MortonConfig &cfg, const GemmDims &d);
+
+// Bytes of the Z-ordered copies of A, B and C (real tiles only; padded tiles are not stored)
+double morton_layout_bytes(const MortonConfig &cfg, const GemmDims &d);
+
+// Grows the per-thread tile buffers of num_threads OpenMP threads for this shape,
+// so timed calls do not allocate. Returns false if the allocation failed.
+bool morton_reserve(const MortonConfig &cfg, const GemmDims &d, int num_threads);
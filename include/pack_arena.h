@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+// Per-thread packing workspace shared by all runners. Each thread owns one A and one B
+// buffer that only ever grow: a larger request replaces the buffer with a prefaulted one,
+// and every later call on that thread reuses it, so steady-state runs never allocate.
+namespace pack_arena {
+
+// Points *a and *b at the calling thread's buffers, grown to at least a_elems / b_elems
+// doubles (64-byte aligned). Returns false if growing failed.
+bool acquire(size_t a_elems, size_t b_elems, double **a, double **b);
+
+// acquire() for packed element types other than double (--dtype f32 / bf16): the buffers
+// are sized in doubles, so an arena reserved for a double run also covers narrower types.
+template <typename P>
+bool acquire_as(size_t a_elems, size_t b_elems, P **a, P **b) {
+    static_assert(sizeof(double) % sizeof(P) == 0, "packed type must tile a double");
+    constexpr size_t per_double = sizeof(double) / sizeof(P);
+    double *da, *db;
+    if (!acquire((a_elems + per_double - 1) / per_double, (b_elems + per_double - 1) / per_double, &da, &db)) {
+        return false;
+    }
+    *a = reinterpret_cast<P *>(da);
+    *b = reinterpret_cast<P *>(db);
+    return true;
+}
+
+// Grows the buffers of num_threads OpenMP threads ahead of time (outside the timed region)
+bool reserve(size_t a_elems, size_t b_elems, int num_threads);
+
+// Number of buffer (re)allocations so far, over all threads
+long growths();
+
+} // namespace pack_arena
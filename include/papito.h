@@ -9,15 +9,75 @@ extern "C" {
 #endif
 
 // API simples usada pelo código principal
-void papito_init();           // inicializa PAPI e carrega counters.in
+void papito_init();           // inicializa PAPI e carrega counters.in (encerra o processo se falhar)
+// Como papito_init, mas devolve o status em vez de encerrar o processo (uso como biblioteca);
+// depois de uma falha nada fica inicializado e uma nova chamada tenta de novo
+enum {
+    PAPITO_OK = 0,
+    PAPITO_ERR_VERSION,       // libpapi diferente da usada na compilação
+    PAPITO_ERR_INIT,          // PAPI_library_init falhou
+    PAPITO_ERR_EVENTSET,      // PAPI_create_eventset falhou
+};
+int papito_try_init();
 void papito_start();          // começa a contagem
 void papito_end();            // pára e imprime resultados (stdout)
 void papito_finalize();       // final cleanup (opcional)
+void papito_cache_sizes(long *l1d, long *l2, long *l3); // tamanhos de cache em bytes (0 = desconhecido)
+void papito_set_quiet(int quiet); // 1: sem mensagens [papito] nem linhas PAPITO_* no stderr (uso como biblioteca)
+
+// Regiões nomeadas e aninháveis: acumulam os contadores entre begin/end em todas as entradas
+// entre papito_start e papito_end, que imprime uma linha PAPITO_REGION por região.
+// Regiões aninhadas são identificadas pelo caminho (ex.: "gemm/pack_B"). Chamadas feitas
+// dentro de uma região paralela OpenMP, ou sem eventos configurados, são ignoradas.
+// Desativadas por padrão (cada entrada custa dois PAPI_read): PAPITO_REGIONS=1 as ativa.
+void papito_region_begin(const char *name);
+void papito_region_end(const char *name);
+// Variantes para o caminho quente: o id vem de papito_region_id (registrado uma vez, fora do
+// laço) e begin/end não alocam nem comparam strings
+int papito_region_id(const char *name);
+void papito_region_begin_id(int id);
+void papito_region_end_id(int id);
+
+// Ganchos por thread para regiões paralelas OpenMP: cada thread trabalhadora registra-se no
+// PAPI e conta com o seu próprio EventSet entre begin/end; a thread principal usa o EventSet
+// global. As contagens são acumuladas por número de thread OpenMP e impressas por papito_end
+// (PAPITO_THREAD, total agregado e desbalanceamento max/média).
+// Os EventSets das threads ficam ativos até papito_finalize; papito_thread_prepare os cria
+// de antemão (fora da região medida) numa equipe de num_threads, senão a primeira região paga.
+void papito_thread_prepare(int num_threads);
+void papito_thread_begin();
+void papito_thread_end();
 
-// Funções C++-style (apenas se incluir papito.h em C++ files)
 #ifdef __cplusplus
 }
 #endif
 
+// Funções C++-style (apenas se incluir papito.h em C++ files)
+#ifdef __cplusplus
+struct PapitoRegionResult {
+    std::string path;            // ex.: "gemm/pack_B"
+    long long entries = 0;
+    std::vector<long long> values; // mesma ordem de event_names
+};
+
+struct PapitoThreadResult {
+    int thread = 0;              // omp_get_thread_num()
+    long long entries = 0;
+    std::vector<long long> values;
+};
+
+struct PapitoResults {
+    std::vector<std::string> event_names;  // eventos medidos
+    std::vector<long long> values;
+    std::vector<std::string> dropped;      // eventos de counters.in que não puderam ser adicionados
+    bool multiplexed = false;
+    std::vector<PapitoRegionResult> regions;
+    std::vector<PapitoThreadResult> threads; // só quando houve regiões paralelas instrumentadas
+};
+
+// Resultados do último papito_end (vazio antes da primeira medição)
+const PapitoResults& papito_last_results();
+#endif
+
 #endif // PAPITO_H
 
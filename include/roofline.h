@@ -0,0 +1,34 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "dtype.h"
+#include "gemm_dims.h"
+#include "papito.h"
+#include <string>
+
+// The machine model (FMA pipes, L2 and DRAM bandwidth) lives in src/roofline.cpp and can be
+// overridden at build time: make ROOFLINE_DEFINES="-DROOFLINE_DRAM_GBS=40"
+
+// Derived metrics for one run. Byte counts and intensities are per product (one repeat,
+// all batch entries); NaN marks values whose counters were not measured.
+struct RooflineResult {
+    double gflops = 0.0;
+    double ghz = 0.0;                  // measured from PAPI_TOT_CYC, else ROOFLINE_GHZ
+    double flops_per_cycle = 0.0;      // per core
+    double peak_flops_per_cycle = 0.0; // per core, for the kernel's ISA
+    double peak_gflops = 0.0;          // all threads
+    double peak_share = 0.0;           // gflops / peak_gflops
+    double l2_bytes = 0.0;             // PAPI_L1_DCM lines, i.e. L2 -> L1 traffic
+    double dram_bytes = 0.0;           // PAPI_L2_DCM lines, or the compulsory A+B+2C traffic
+    bool dram_from_counters = false;
+    double ai_l2 = 0.0, ai_dram = 0.0; // FLOPs per byte at each level
+    double l2_roof_gflops = 0.0, dram_roof_gflops = 0.0;
+    std::string bound;                 // "compute", "l2" or "dram": the lowest roof
+};
+
+// flops and seconds describe one product (median repeat); the counters cover `repeats`
+// products. Per-thread counters are summed when the run was multithreaded. dtype scales the
+// vector peak (f32: 2x the double lanes, bf16 dot products: 4x) and the compulsory bytes.
+RooflineResult compute_roofline(const GemmDims &d, int batch, int threads, int repeats, IsaLevel isa,
+                                double flops, double seconds, const PapitoResults &papi,
+                                Dtype dtype = Dtype::f64);
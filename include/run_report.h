@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bench_stats.h"
+#include "papito.h"
+#include "roofline.h"
+#include "verify.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// Everything main() knows about one benchmark run, for the structured --format output
+struct RunReport {
+    int N = 0, M = 0, K = 0, BS = 0;
+    std::string mode, runner, isa;
+    std::string dtype = "f64";       // element type of the block path (--dtype)
+    std::string alloc = "aligned", numa = "none"; // page policy granted for A, NUMA policy
+    std::string affinity = "none", cpus;         // --affinity policy and the CPU of each thread
+    std::string schedule;                        // --schedule of the multithreaded block runner
+    double sched_steals = NAN, sched_imbalance = NAN; // NaN when no tiles were distributed
+    unsigned int seed = 0;
+    int threads = 1, batch = 1, warmup = 0, repeats = 1;
+    TimingStats timing;
+    double checksum = 0.0;
+    double alloc_seconds = 0.0, fill_seconds = 0.0, checksum_seconds = 0.0; // untimed setup
+    double flops = 0.0;              // floating-point operations of one repeat
+    std::string energy_source = "none"; // "powercap" when RAPL counters were readable
+    double energy_joules = NAN, energy_watts = NAN, gflops_per_joule = NAN; // per repeat, average, per repeat
+    bool have_phases = false;        // pack/kernel split (bpanel and goto runners)
+    double pack_seconds = 0.0, kernel_seconds = 0.0;
+    RooflineResult roofline;
+    bool verify = false;             // --verify ran; verify_result is meaningful
+    VerifyResult verify_result;
+};
+
+// "json" and "csv" are the supported structured formats
+bool valid_report_format(const std::string &format);
+
+// Writes one record: JSON as a single object on one line, CSV as a header line plus one row.
+// Derived metrics (IPC, miss rates) are null / empty when their counters were not measured.
+void write_run_report(FILE *out, const std::string &format, const RunReport &r, const PapitoResults &papi);
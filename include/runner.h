@@ -1,6 +1,62 @@
 #pragma once
 
+#include "gemm_dims.h"
 #include "kernels.h"
+#include "tile_scheduler.h"
+#include <string>
 
-void run_benchmark(const double *A, const double *B, double *C, int N, int BS, matmul_func_t kernel);
+// Wall time split reported by runners that time packing and compute separately
+struct RunnerPhaseTimes {
+    double pack_seconds = 0.0;
+    double kernel_seconds = 0.0;
+};
 
+// Separate cache-level block sizes for run_benchmark_goto (all multiples of BS;
+// only the last block along each dimension may be partial)
+struct GotoBlocking {
+    int MC = 0; // rows of the packed A block (L2)
+    int KC = 0; // shared k depth of the packed A block and B panel
+    int NC = 0; // columns of the packed B panel (L3)
+};
+
+// Sizes and prefaults the packing workspace (see pack_arena.h) of num_threads threads for
+// the given runner ("block", "bpanel" or "goto"; blk is only read by goto), so timed calls
+// do not allocate. Returns false if the buffers could not be allocated.
+bool reserve_pack_workspace(const std::string &runner, const GemmDims &d, int BS, const GotoBlocking &blk,
+                            int num_threads);
+
+// The block runners are templated on the C element type T and the packed element type P
+// (see matmul_kernel_t); they are instantiated for <double>, <float> and <float, bf16_t>.
+// Operands are always T; the packers convert them to P on the way into the buffers.
+template <typename T, typename P>
+void run_benchmark(const T *A, const T *B, T *C, const GemmDims &d, int BS, matmul_kernel_t<T, P> kernel);
+
+// Batch of independent GEMMs sharing one shape: entry b computes Cs[b] += As[b] * Bs[b].
+// Entries are parallelised over num_threads and each thread reuses its packing buffers.
+template <typename T, typename P>
+void run_benchmark_batched(const T *const *As, const T *const *Bs, T *const *Cs, int batch,
+                           const GemmDims &d, int BS, matmul_kernel_t<T, P> kernel, int num_threads);
+
+// Multithreaded variant of run_benchmark: splits the C tile space across num_threads threads,
+// statically or through work-stealing deques (see tile_scheduler.h). Adds each thread's busy
+// time, tiles and steals to *stats (if non-null). The steal schedule deals its tasks through
+// the caller's *queues (reserved for num_threads up front, so the call does not allocate);
+// concurrent calls need their own TileQueues.
+template <typename T, typename P>
+void run_benchmark_parallel(const T *A, const T *B, T *C, const GemmDims &d, int BS,
+                            matmul_kernel_t<T, P> kernel, int num_threads,
+                            TileSchedule schedule = TileSchedule::static_split, SchedStats *stats = nullptr,
+                            TileQueues *queues = nullptr);
+
+// Packs each BS x N k-panel of B once and reuses it for every i0 row-block.
+// Fills *times (if non-null) with the time spent packing vs. inside the kernel.
+void run_benchmark_bpanel(const double *A, const double *B, double *C, const GemmDims &d, int BS,
+                          matmul_func_t kernel, RunnerPhaseTimes *times);
+
+// Derives MC/KC/NC from the L2/L3 sizes in bytes (0 = unknown, a default is assumed).
+GotoBlocking goto_blocking_from_cache(long l2_bytes, long l3_bytes, const GemmDims &d, int BS);
+
+// GotoBLAS-style five-loop runner with independent MC/KC/NC; the block kernel computes
+// each BS x BS micro-block. Fills *times (if non-null) with the pack/kernel split.
+void run_benchmark_goto(const double *A, const double *B, double *C, const GemmDims &d, int BS,
+                        const GotoBlocking &blk, matmul_func_t kernel, RunnerPhaseTimes *times);
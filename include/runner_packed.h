@@ -0,0 +1,8 @@
+#pragma once
+
+#include "gemm_dims.h"
+#include "kernels_packed.h"
+
+// Same loop nest as run_benchmark, but packs A and B into MR/NR slivers (see kernels_packed.h).
+void run_benchmark_packed(const double *A, const double *B, double *C, const GemmDims &d, int BS,
+                          matmul_packed_func_t kernel);
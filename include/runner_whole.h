@@ -1,6 +1,21 @@
 #pragma once
 
+#include "gemm_dims.h"
 #include "kernels_whole.h"
+#include "morton.h"
+#include "strassen.h"
 
-void run_benchmark_whole_matrix(const double *A, const double *B, double *C, int N, matmul_whole_func_t kernel);
+// Whole-matrix kernel to run; strassen and morton take their configuration from here
+// rather than from shared state, so callers with different configurations can run at once.
+struct WholeKernel {
+    matmul_whole_func_t func = nullptr;
+    const StrassenConfig *strassen = nullptr; // set: strassen_gemm under this configuration
+    const MortonConfig *morton = nullptr;     // set: morton_gemm under this configuration
+};
 
+void run_benchmark_whole_matrix(const double *A, const double *B, double *C, const GemmDims &d,
+                                const WholeKernel &kernel);
+
+// Batch of independent whole-matrix GEMMs sharing one shape, parallelised over num_threads.
+void run_benchmark_whole_batched(const double *const *As, const double *const *Bs, double *const *Cs, int batch,
+                                 const GemmDims &d, const WholeKernel &kernel, int num_threads);
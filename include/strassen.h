@@ -0,0 +1,30 @@
+#pragma once
+
+#include "gemm_dims.h"
+#include "kernels.h"
+
+// Strassen-Winograd recursion behind the "strassen" whole-matrix mode (kernel_strassen_whole
+// runs it with the default StrassenConfig; matmul_select keeps one per context).
+// Each level splits C = A * B into quadrants and does 7 half-size products plus 15 quadrant
+// additions; odd dimensions are peeled off and fixed up with O(n^2) loops.
+struct StrassenConfig {
+    int cutoff = 512;             // recurse only while min(M, N, K) > cutoff
+    int max_levels = 2;
+    matmul_func_t leaf = nullptr; // block kernel for the leaf products; nullptr = kernel_blas_whole
+    int leaf_bs = 64;             // BS passed to the block runner when leaf is set
+};
+
+// C = A * B (row-major, C overwritten) under cfg
+void strassen_gemm(const StrassenConfig &cfg, const double *A, const double *B, double *C,
+                   int M, int N, int K, int lda, int ldb, int ldc);
+
+// Recursion depth cfg applies to this shape
+int strassen_levels(const StrassenConfig &cfg, const GemmDims &d);
+
+// FLOPs actually executed (leaf products, quadrant additions and fix-ups), to compare
+// with the classical 2*M*N*K
+double strassen_flops(const StrassenConfig &cfg, const GemmDims &d);
+
+// Grows the per-thread temporary workspace of num_threads OpenMP threads for this shape,
+// so timed calls do not allocate. Returns false if the allocation failed.
+bool strassen_reserve(const StrassenConfig &cfg, const GemmDims &d, int num_threads);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gemm_dims.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// How run_benchmark_parallel hands the (i0, j0) C tiles to its threads (--schedule)
+enum class TileSchedule {
+    static_split, // omp for schedule(static): one contiguous, equal range of tiles per thread
+    steal,        // the same ranges as per-thread deques of tile groups; idle threads steal
+};
+
+bool parse_tile_schedule(const std::string &name, TileSchedule *out);
+const char* tile_schedule_name(TileSchedule s);
+
+struct ThreadSchedStats {
+    double busy_seconds = 0.0; // time spent computing tiles (idle = wall - busy)
+    long tiles = 0;
+    long steals = 0;           // tasks taken from another thread's deque
+};
+
+// Filled by run_benchmark_parallel; the per-thread entries accumulate over the calls
+struct SchedStats {
+    int task_tiles = 1;        // tiles per task
+    long tasks = 0;
+    std::vector<ThreadSchedStats> threads;
+};
+
+// Tiles per steal task: enough k-depth work (STEAL_TASK_FLOPS) to amortise taking the task,
+// but at most what leaves STEAL_TASKS_PER_THREAD tasks per thread to balance with
+int steal_task_tiles(const GemmDims &d, int BS, int num_threads);
+
+// A fixed set of tasks [0, ntasks) dealt to per-thread deques in contiguous ranges. The
+// owner pops from the front, preserving the static (cache-friendly) order; thieves take
+// from the back. Each deque is one atomic (head, tail) word, so both ends are lock-free,
+// and since no task is ever pushed, a deque seen empty stays empty. The deques only grow
+// (reserve), so a reserved instance is reset per call without allocating.
+class TileQueues {
+public:
+    // Grows the storage to at least nthreads deques; false if the allocation failed
+    bool reserve(int nthreads);
+    // Deals [0, ntasks) to the first nthreads deques (nthreads <= the reserved count)
+    void reset(long ntasks, int nthreads);
+
+    bool pop(int tid, long *task);
+    // Scans the other deques round-robin from tid + 1
+    bool steal(int tid, long *task);
+
+private:
+    struct alignas(64) Deque {
+        std::atomic<uint64_t> range{0}; // head << 32 | tail
+    };
+    int capacity_ = 0;
+    int nthreads_ = 0;
+    std::unique_ptr<Deque[]> deques_;
+};
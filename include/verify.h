@@ -0,0 +1,30 @@
+#pragma once
+
+#include "gemm_dims.h"
+#include <string>
+
+// Outcome of checking C = A * B for every batch entry
+struct VerifyResult {
+    std::string method;            // "blas" or "freivalds"
+    bool ok = true;
+    double max_abs = 0.0;          // largest |C - reference|
+    double max_rel = 0.0;          // largest error relative to its scale (see below)
+    long mismatches = 0;           // entries (blas) or rows (freivalds) above the tolerance
+    int first_batch = -1, first_row = -1, first_col = -1; // first mismatch; col is -1 for freivalds
+};
+
+// Reference-based check: recomputes each product with kernel_blas_whole and compares
+// element-wise; the relative error of C[i][j] is taken against |ref[i][j]|.
+// Cost: one extra GEMM and an M x N scratch matrix.
+bool verify_blas(const double *A, const double *B, const double *C, const GemmDims &d, int batch,
+                 double rtol, VerifyResult *res);
+
+// Freivalds check with `vectors` random x: compares C x against A (B x) row by row, with
+// the error scaled by (|A| (|B| |x|))_i, the magnitude the dot products went through.
+// rtol <= 0 selects the rounding-error bound (2K + N) u, which a correct C cannot exceed.
+// Cost: O(MK + KN + MN) per vector; a wrong row survives one vector with probability ~0.
+bool verify_freivalds(const double *A, const double *B, const double *C, const GemmDims &d, int batch,
+                      double rtol, unsigned int seed, int vectors, VerifyResult *res);
+
+// Problems up to this many multiply-adds get the exact blas check under --verify auto
+constexpr double VERIFY_BLAS_MAX_FMAS = 1024.0 * 1024.0 * 1024.0;
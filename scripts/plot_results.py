@@ -28,6 +28,7 @@ from pathlib import Path
 # --- Lógica de Extração de Dados ---
 PAPITO_COUNTERS_RE = re.compile(r"^PAPITO_COUNTERS\s*(.*)$")
 PAPITO_VALUES_RE = re.compile(r"^PAPITO_VALUES\s*(.*)$")
+ROOFLINE_RE = re.compile(r"^ROOFLINE\s*(.*)$")
 
 def parse_papito_from_log(logpath: Path):
     """Extrai os contadores e valores do PAPI de um arquivo de log."""
@@ -49,6 +50,23 @@ def parse_papito_from_log(logpath: Path):
     return None
 
 
+def parse_roofline_from_log(logpath: Path):
+    """Extrai a linha ROOFLINE (chave=valor) como colunas roof_<chave>."""
+    roof = {}
+    try:
+        with logpath.open("r", errors="ignore") as f:
+            for line in f:
+                if m := ROOFLINE_RE.match(line):
+                    roof = {}
+                    for field in m.group(1).split("\t"):
+                        key, _, value = field.partition("=")
+                        num = pd.to_numeric(value, errors="coerce")
+                        roof[f"roof_{key}"] = value if key in ("bound", "dram_source") else num
+    except FileNotFoundError:
+        return None
+    return roof or None
+
+
 def build_dataframe(results_dir: Path):
     """Constrói um DataFrame do pandas a partir do runs.csv e arquivos de log associados."""
     runs_csv_path = results_dir / "runs.csv"
@@ -66,7 +84,13 @@ def build_dataframe(results_dir: Path):
     ]
     papi_df = pd.DataFrame([d if d else {} for d in papi_data], index=df.index)
 
-    return pd.concat([df, papi_df], axis=1)
+    roof_data = [
+        parse_roofline_from_log(results_dir / Path(row["logfile"]).name)
+        for _, row in df.iterrows()
+    ]
+    roof_df = pd.DataFrame([d if d else {} for d in roof_data], index=df.index)
+
+    return pd.concat([df, papi_df, roof_df], axis=1)
 
 
 def calculate_metrics(df: pd.DataFrame, rename_map: dict):
@@ -135,11 +159,14 @@ def plot_by_bs_and_metric(df: pd.DataFrame, plot_dir: Path):
 
     metrics_to_plot = {
         "elapsed_s": "Tempo de Execução (s)",
+        "roof_gflops": "Desempenho (GFLOP/s)",
         "IPC": "Instruções por Ciclo (IPC)",
         "PAPI_TOT_CYC": "Total de Ciclos",
         "energy_J": "Consumo de Energia (Joules)",
+        "gflops_per_J": "Eficiência Energética (GFLOP/J)",
         "L1_HIT_RATE": "Taxa de Acerto do Cache L1 (%)",
         "L2_HIT_RATE": "Taxa de Acerto do Cache L2 (%)",
+        "PAPI_TLB_DM": "Faltas de dTLB",
         "VEC_INS_PERCENT": "Percentual de Instruções Vetoriais (%)",
         "VECTORIZED_FP_PERCENT": "Percentual de FP Vetorizado (%)",
     }
@@ -237,6 +264,7 @@ def plot_best_vs_whole(df: pd.DataFrame, plot_dir: Path):
         "IPC": "Instruções por Ciclo (IPC)",
         "PAPI_TOT_CYC": "Total de Ciclos",
         "energy_J": "Consumo de Energia (Joules)",
+        "gflops_per_J": "Eficiência Energética (GFLOP/J)",
     }
 
     for metric, title in metrics_to_plot.items():
@@ -275,6 +303,46 @@ def plot_best_vs_whole(df: pd.DataFrame, plot_dir: Path):
         plt.savefig(out_path, dpi=150)
         plt.close()
 
+def plot_roofline(df: pd.DataFrame, plot_dir: Path):
+    """
+    Desenha cada execução como um ponto (intensidade aritmética DRAM, GFLOP/s) sob os
+    tetos de pico computacional e de banda de memória reportados pelo binário.
+    """
+    needed = ["roof_ai_dram", "roof_gflops", "roof_peak_gflops", "roof_dram_roof_gflops"]
+    if any(c not in df.columns for c in needed) or df["roof_gflops"].isnull().all():
+        print("Nenhuma linha ROOFLINE encontrada nos logs; gráfico de roofline ignorado.")
+        return
+
+    points = df.dropna(subset=["roof_ai_dram", "roof_gflops"])
+    grouped = points.groupby(["display_mode", "N"]).mean(numeric_only=True).reset_index()
+
+    peak = points["roof_peak_gflops"].max()
+    bandwidth = (points["roof_dram_roof_gflops"] / points["roof_ai_dram"]).median()  # GB/s
+    ai = np.logspace(np.log10(max(grouped["roof_ai_dram"].min() / 4, 1e-2)),
+                     np.log10(grouped["roof_ai_dram"].max() * 4), 200)
+
+    plt.figure(figsize=(14, 8))
+    sns.set_theme(style="whitegrid", font_scale=1.2)
+    ax = plt.gca()
+    ax.plot(ai, np.minimum(peak, ai * bandwidth), color="black", linewidth=2,
+            label=f"Teto ({peak:.0f} GFLOP/s, {bandwidth:.0f} GB/s)")
+    sns.scatterplot(data=grouped, x="roof_ai_dram", y="roof_gflops", hue="display_mode",
+                    size="N", sizes=(40, 300), palette="bright", ax=ax)
+
+    ax.set_title("Roofline: Desempenho vs. Intensidade Aritmética", fontsize=20, weight="bold")
+    ax.set_xlabel("Intensidade Aritmética (FLOP/byte de DRAM)", fontsize=14)
+    ax.set_ylabel("Desempenho (GFLOP/s)", fontsize=14)
+    ax.set_xscale("log")
+    ax.set_yscale("log")
+    ax.grid(True, which="both", ls="--")
+    ax.legend(fontsize=10, loc="lower right")
+
+    out_path = plot_dir / "roofline.png"
+    plt.tight_layout()
+    print(f"Salvando gráfico de roofline em {out_path}")
+    plt.savefig(out_path, dpi=150)
+    plt.close()
+
 # --- Execução Principal ---
 def main():
     parser = argparse.ArgumentParser(
@@ -355,6 +423,7 @@ def main():
         
         plot_by_bs_and_metric(df_analyzed, plot_dir)
         plot_best_vs_whole(df_analyzed, plot_dir)
+        plot_roofline(df_analyzed, plot_dir)
 
         print(
             f"\nPlotagem completa! 🎨 Seus novos gráficos estão no diretório '{plot_dir}'."
@@ -9,10 +9,13 @@ ROOT="$(cd "$(dirname "$0")/.." && pwd)"
 BIN="${ROOT}/bin/matmul_mixed"
 RESULTS_DIR="${ROOT}/results"
 TASK_CPU=0
+# The binary pins itself (main and worker threads); a CPU list, compact or scatter
+AFFINITY="${AFFINITY:-${TASK_CPU}}"
 
 # --- Separate modes into two categories ---
 WHOLE_MODES=(scalar_whole blas_whole)
-BLOCK_MODES=(avx scalar hybrid interleaved blas)
+# morton is a whole-matrix mode, but BS sets its Z-order tile, so it is swept with the block modes
+BLOCK_MODES=(avx avx_pf avx_nt avx_tile avx_packed scalar hybrid interleaved interleaved_pf interleaved_nt blas morton)
 
 # --- Configuration ---
 REPEATS=15 # Keep repeats low for a broad test, can be increased later
@@ -58,6 +61,18 @@ if command -v perf &> /dev/null; then
     fi
 fi
 
+# The binary reads RAPL itself around the timed repeats (ENERGY line); perf, which also
+# counts setup, is only the fallback when powercap is not readable
+read_energy_line() {
+    local line
+    line=$(grep "^ENERGY" "$1" | tail -n1)
+    [[ "$line" == *"source=powercap"* ]] || return 0
+    energy_source="powercap"
+    energy_J=$(echo "$line" | sed -n 's/.*\tjoules=\([^\t]*\).*/\1/p')
+    avg_power_W=$(echo "$line" | sed -n 's/.*\twatts=\([^\t]*\).*/\1/p')
+    gflops_per_J=$(echo "$line" | sed -n 's/.*\tgflops_per_j=\([^\t]*\).*/\1/p')
+}
+
 echo "[run] Starting benchmark..."
 mkdir -p "${RESULTS_DIR}"
 
@@ -66,12 +81,12 @@ echo "[run] Setting CPU governor to 'performance' (may require sudo)..."
 sudo sh -c 'for cpu in /sys/devices/system/cpu/cpu[0-9]*; do echo performance > $cpu/cpufreq/scaling_governor 2>/dev/null || true; done'
 
 CSV="${RESULTS_DIR}/runs.csv"
-echo "timestamp,mode,N,BS,run,elapsed_s,checksum,logfile,tuning,energy_J,avg_power_W,effective_freq_GHz" > "${CSV}"
+echo "timestamp,mode,N,BS,run,elapsed_s,checksum,logfile,tuning,energy_J,avg_power_W,effective_freq_GHz,gflops_per_J,energy_source" > "${CSV}"
 
 # --- Part 1: Run Whole-Matrix Modes ---
 echo
 echo "--- Running Whole-Matrix Modes (once per matrix size) ---"
-(cd "${ROOT}" && make -j$(nproc)) # Ensure project is built once for these modes
+(cd "${ROOT}" && make -j$(nproc)) # One build covers every mode and tuning
 for N in "${N_VALUES[@]}"; do
     for mode in "${WHOLE_MODES[@]}"; do
         # BS is not applicable, use 0 as a placeholder. Run is always 1.
@@ -83,7 +98,7 @@ for N in "${N_VALUES[@]}"; do
         perf_logfile="${RESULTS_DIR}/${mode}_N${N}.perf"
         echo "=== RUN ${mode} N=${N} ===" > "${logfile}"
         
-        BENCH_CMD="taskset -c ${TASK_CPU} ${BIN} ${N} ${BS} ${mode} $((RANDOM & 0x7fffffff))"
+        BENCH_CMD="${BIN} ${N} ${BS} ${mode} $((RANDOM & 0x7fffffff)) --affinity ${AFFINITY}"
         EXEC_CMD="${BENCH_CMD}"
         if [ "$USE_PERF" -eq 1 ]; then
             PERF_EVENTS="power/energy-pkg/"
@@ -97,8 +112,10 @@ for N in "${N_VALUES[@]}"; do
         elapsed=$(echo "${SUMMARY}" | sed -n 's/.*seconds=\([0-9.]*\).*/\1/p' || echo "NA")
         checksum=$(echo "${SUMMARY}" | sed -n 's/.*checksum=\([0-g.eE+-]*\).*/\1/p' || echo "NA")
         
-        energy_J="NA"; avg_power_W="NA"; effective_freq_GHz="NA"
-        if [ "$USE_PERF" -eq 1 ] && [ -f "${perf_logfile}" ]; then
+        energy_J="NA"; avg_power_W="NA"; effective_freq_GHz="NA"; gflops_per_J="NA"; energy_source="NA"
+        read_energy_line "${logfile}"
+        if [ "$energy_source" == "NA" ] && [ "$USE_PERF" -eq 1 ] && [ -f "${perf_logfile}" ]; then
+            energy_source="perf"
             perf_data=$(awk '/power\/energy-pkg/ {e=$1} /cpu-cycles/ {c=$1} END {printf "%.4f,%.0f", e, c}' "${perf_logfile}")
             energy_J=$(echo "$perf_data" | cut -d',' -f1); cycles=$(echo "$perf_data" | cut -d',' -f2)
             if [[ "$elapsed" != "NA" && "$elapsed" != "0" ]]; then
@@ -107,7 +124,7 @@ for N in "${N_VALUES[@]}"; do
             fi
         fi
         
-        echo "$(date +%FTT%z),${mode},${N},${BS},${run},${elapsed},${checksum},${logfile},${tuning},${energy_J},${avg_power_W},${effective_freq_GHz}" >> "${CSV}"
+        echo "$(date +%FTT%z),${mode},${N},${BS},${run},${elapsed},${checksum},${logfile},${tuning},${energy_J},${avg_power_W},${effective_freq_GHz},${gflops_per_J},${energy_source}" >> "${CSV}"
         sleep 1
     done
 done
@@ -125,10 +142,11 @@ for N in "${N_VALUES[@]}"; do
       if [ "$mode" == "interleaved" ]; then CURRENT_TUNINGS=("${INTERLEAVED_TUNINGS[@]}"); fi
 
       for tuning in "${CURRENT_TUNINGS[@]}"; do
+        # Every tuning of the grid is built into the binary as e.g. "interleaved<2,8>"
+        run_mode="${mode}"
         if [ "$tuning" != "NA" ]; then
           AVX_OPS=$(echo "$tuning" | cut -d'_' -f1); SCALAR_OPS=$(echo "$tuning" | cut -d'_' -f2)
-          echo "--- Recompiling for ${mode} with tuning ${tuning} ---"
-          (cd "${ROOT}" && make clean > /dev/null && make -j$(nproc) "HYBRID_AVX_UNROLL=${AVX_OPS}" "HYBRID_SCALAR_UNROLL=${SCALAR_OPS}" "INTERLEAVED_AVX_OPS=${AVX_OPS}" "INTERLEAVED_SCALAR_OPS=${SCALAR_OPS}")
+          run_mode="${mode}<${AVX_OPS},${SCALAR_OPS}>"
         fi
 
         for run in $(seq 1 ${REPEATS}); do
@@ -136,7 +154,7 @@ for N in "${N_VALUES[@]}"; do
           perf_logfile="${RESULTS_DIR}/${mode}_${tuning}_N${N}_BS${BS}_run${run}.perf"
           echo "=== RUN ${mode} (tuning: ${tuning}) N=${N} BS=${BS} run=${run} ===" > "${logfile}"
 
-          BENCH_CMD="taskset -c ${TASK_CPU} ${BIN} ${N} ${BS} ${mode} $((RANDOM & 0x7fffffff))"
+          BENCH_CMD="${BIN} ${N} ${BS} '${run_mode}' $((RANDOM & 0x7fffffff)) --affinity ${AFFINITY}"
           EXEC_CMD="${BENCH_CMD}"
           if [ "$USE_PERF" -eq 1 ]; then
               PERF_EVENTS="power/energy-pkg/"
@@ -150,8 +168,10 @@ for N in "${N_VALUES[@]}"; do
           elapsed=$(echo "${SUMMARY}" | sed -n 's/.*seconds=\([0-9.]*\).*/\1/p' || echo "NA")
           checksum=$(echo "${SUMMARY}" | sed -n 's/.*checksum=\([0-9.eE+-]*\).*/\1/p' || echo "NA")
           
-          energy_J="NA"; avg_power_W="NA"; effective_freq_GHz="NA"
-          if [ "$USE_PERF" -eq 1 ] && [ -f "${perf_logfile}" ]; then
+          energy_J="NA"; avg_power_W="NA"; effective_freq_GHz="NA"; gflops_per_J="NA"; energy_source="NA"
+          read_energy_line "${logfile}"
+          if [ "$energy_source" == "NA" ] && [ "$USE_PERF" -eq 1 ] && [ -f "${perf_logfile}" ]; then
+              energy_source="perf"
               perf_data=$(awk '/power\/energy-pkg/ {e=$1} /cpu-cycles/ {c=$1} END {printf "%.4f,%.0f", e, c}' "${perf_logfile}")
               energy_J=$(echo "$perf_data" | cut -d',' -f1); cycles=$(echo "$perf_data" | cut -d',' -f2)
               if [[ "$elapsed" != "NA" && "$elapsed" != "0" ]]; then
@@ -160,7 +180,7 @@ for N in "${N_VALUES[@]}"; do
               fi
           fi
           
-          echo "$(date +%FTT%z),${mode},${N},${BS},${run},${elapsed},${checksum},${logfile},${tuning},${energy_J},${avg_power_W},${effective_freq_GHz}" >> "${CSV}"
+          echo "$(date +%FTT%z),${mode},${N},${BS},${run},${elapsed},${checksum},${logfile},${tuning},${energy_J},${avg_power_W},${effective_freq_GHz},${gflops_per_J},${energy_source}" >> "${CSV}"
           sleep 1
         done
       done
@@ -14,13 +14,24 @@ N=128
 BS=64
 SEED=42
 GOLDEN_MODE="blas_whole"
+# Production-size pass: checked in-process with --verify (Freivalds), no text dump
+LARGE_N=1536
 MODES_TO_TEST=(
     "scalar_whole"
     "scalar"
     "avx"
+    "avx_tile"
+    "avx_packed"
+    "scalar_packed"
     "blas"
     "hybrid"
     "interleaved"
+    "avx_pf"
+    "avx_nt"
+    "interleaved_pf"
+    "interleaved_nt"
+    "strassen"
+    "morton"
 )
 
 # --- Tunings for Hybrid and Interleaved Kernels ---
@@ -50,8 +61,8 @@ echo "--- Sanity Check for Matrix Multiplication Kernels ---"
 TMP_DIR=$(mktemp -d)
 trap 'rm -rf -- "$TMP_DIR"' EXIT
 
-# 1. Generate the golden reference output using the default build
-echo "[BUILD] Compiling default version for golden reference..."
+# 1. Build once (all tunings are in the binary) and generate the golden reference output
+echo "[BUILD] Compiling..."
 (cd "${ROOT}" && make -j$(nproc) > /dev/null 2>&1)
 echo "[BUILD] Done."
 
@@ -97,29 +108,131 @@ for mode in "${MODES_TO_TEST[@]}"; do
     }
     # --- End of Test Logic ---
 
-    if [ "$mode" == "hybrid" ]; then
-        for tuning in "${HYBRID_TUNINGS[@]}"; do
-            AVX_OPS=$(echo "$tuning" | cut -d'_' -f1)
-            SCALAR_OPS=$(echo "$tuning" | cut -d'_' -f2)
-            echo "[BUILD] Recompiling for hybrid tuning: ${tuning}..."
-            (cd "${ROOT}" && make clean > /dev/null && make -j$(nproc) "HYBRID_AVX_UNROLL=${AVX_OPS}" "HYBRID_SCALAR_UNROLL=${SCALAR_OPS}" > /dev/null 2>&1)
-            test_kernel "$mode" "$tuning"
-        done
-    elif [ "$mode" == "interleaved" ]; then
-        for tuning in "${INTERLEAVED_TUNINGS[@]}"; do
+    if [ "$mode" == "hybrid" ] || [ "$mode" == "interleaved" ]; then
+        # Every tuning of the grid is built into the binary as e.g. "interleaved<2,8>"
+        if [ "$mode" == "hybrid" ]; then TUNINGS=("${HYBRID_TUNINGS[@]}"); else TUNINGS=("${INTERLEAVED_TUNINGS[@]}"); fi
+        test_kernel "$mode"
+        for tuning in "${TUNINGS[@]}"; do
             AVX_OPS=$(echo "$tuning" | cut -d'_' -f1)
             SCALAR_OPS=$(echo "$tuning" | cut -d'_' -f2)
-            echo "[BUILD] Recompiling for interleaved tuning: ${tuning}..."
-            (cd "${ROOT}" && make clean > /dev/null && make -j$(nproc) "INTERLEAVED_AVX_OPS=${AVX_OPS}" "INTERLEAVED_SCALAR_OPS=${SCALAR_OPS}" > /dev/null 2>&1)
-            test_kernel "$mode" "$tuning"
+            test_kernel "${mode}<${AVX_OPS},${SCALAR_OPS}>" "$tuning"
         done
     else
-        # For non-tunable modes, compile with default settings and test once
-        (cd "${ROOT}" && make clean > /dev/null && make -j$(nproc) > /dev/null 2>&1)
         test_kernel "$mode"
     fi
 done
 
+# 2b. Large-N pass with the built-in checker
+echo
+for mode in "${MODES_TO_TEST[@]}"; do
+    echo -n "[VERIFY] Running mode '${mode}' at N=${LARGE_N}... "
+    if line=$("${BIN}" $LARGE_N $BS "${mode}" $SEED --verify-method freivalds 2>&1 | grep "^VERIFY") \
+       && [[ "$line" == *"status=PASS"* ]]; then
+        echo -e "\033[0;32mPASS\033[0m"
+    else
+        echo -e "\033[0;31mFAIL\033[0m ${line:-no VERIFY line}"
+        FAILURES=$((FAILURES + 1))
+    fi
+done
+
+# 2c. Reduced-precision block kernels, against their float rounding bound
+for dtype in f32 bf16; do
+    for mode in avx scalar; do
+        echo -n "[VERIFY] Running mode '${mode}' --dtype ${dtype} at N=${LARGE_N}... "
+        if line=$("${BIN}" $LARGE_N $BS "${mode}" $SEED --dtype "$dtype" --verify 2>&1 | grep "^VERIFY") \
+           && [[ "$line" == *"status=PASS"* ]]; then
+            echo -e "\033[0;32mPASS\033[0m"
+        else
+            echo -e "\033[0;31mFAIL\033[0m ${line:-no VERIFY line}"
+            FAILURES=$((FAILURES + 1))
+        fi
+    done
+done
+
+# 2d. Multithreaded block runner with both tile schedules
+for schedule in static steal; do
+    for mode in avx interleaved; do
+        echo -n "[VERIFY] Running mode '${mode}' --threads 3 --schedule ${schedule} at N=${LARGE_N}... "
+        if line=$("${BIN}" $LARGE_N $BS "${mode}" $SEED --threads 3 --schedule "$schedule" --verify 2>&1 | grep "^VERIFY") \
+           && [[ "$line" == *"status=PASS"* ]]; then
+            echo -e "\033[0;32mPASS\033[0m"
+        else
+            echo -e "\033[0;31mFAIL\033[0m ${line:-no VERIFY line}"
+            FAILURES=$((FAILURES + 1))
+        fi
+    done
+done
+
+# Runs the binary with the given arguments and --verify; PASS if the VERIFY line does
+verify_case() {
+    echo -n "[VERIFY] Running $*... "
+    local line
+    if line=$("${BIN}" "$@" --verify 2>&1 | grep "^VERIFY") && [[ "$line" == *"status=PASS"* ]]; then
+        echo -e "\033[0;32mPASS\033[0m"
+    else
+        echo -e "\033[0;31mFAIL\033[0m ${line:-no VERIFY line}"
+        FAILURES=$((FAILURES + 1))
+    fi
+}
+
+# 2e. Sizes the block size does not divide (masked edge tiles) and rectangular shapes
+echo
+EDGE_MODES=("scalar" "avx" "avx_tile" "hybrid" "hybrid<2,4>" "avx_packed" "scalar_packed")
+for mode in "${EDGE_MODES[@]}"; do
+    verify_case 131 64 "$mode" $SEED
+    verify_case 100 48 "$mode" $SEED
+    verify_case $N 48 "$mode" $SEED --shape 200x150x120
+    verify_case $N 64 "$mode" $SEED --shape 77x190x131
+done
+
+# 2f. B-panel and goto runners; goto with explicit and with cache-derived MC/KC/NC
+echo
+for mode in avx hybrid; do
+    verify_case 300 64 "$mode" $SEED --runner bpanel
+    verify_case $N 48 "$mode" $SEED --runner bpanel --shape 200x150x120
+    verify_case 300 64 "$mode" $SEED --runner goto --mc 128 --kc 64 --nc 192
+    verify_case $N 48 "$mode" $SEED --runner goto --mc 96 --kc 48 --nc 144 --shape 200x150x120
+    verify_case 300 64 "$mode" $SEED --runner goto
+    verify_case $N 48 "$mode" $SEED --runner goto --shape 200x150x120
+done
+
+# 2g. Batches: the block runner (static tile split) and the whole-matrix modes
+for threads in 1 3; do
+    verify_case 131 64 avx $SEED --batch 3 --threads $threads --schedule static
+    verify_case $N 48 hybrid $SEED --batch 3 --threads $threads --schedule static --shape 77x190x131
+    verify_case 131 64 blas_whole $SEED --batch 3 --threads $threads
+    verify_case 131 32 strassen $SEED --batch 3 --threads $threads --strassen-cutoff 16 --strassen-leaf avx
+    verify_case 131 32 morton $SEED --batch 3 --threads $threads
+done
+
+# 2h. Matrix file round trip: save the synthetic inputs, rerun on the files (with another
+# seed, so the fill cannot produce them) and expect the same C and VERIFY line
+echo
+echo -n "[FILES] Round trip through --save-inputs and --a-file/--b-file... "
+RT="${TMP_DIR}/roundtrip"
+if first=$("${BIN}" $N 48 avx $SEED --shape 200x150x120 --save-inputs "${RT}" \
+               --c-file "${RT}_C1.mat" --verify 2>&1 | grep "^VERIFY") \
+   && second=$("${BIN}" $N 48 avx $((SEED + 1)) --shape 200x150x120 --a-file "${RT}_A.mat" \
+                   --b-file "${RT}_B.mat" --c-file "${RT}_C2.mat" --verify 2>&1 | grep "^VERIFY") \
+   && [[ "$first" == *"status=PASS"* ]] && [ "$first" == "$second" ] \
+   && cmp -s "${RT}_C1.mat" "${RT}_C2.mat"; then
+    echo -e "\033[0;32mPASS\033[0m"
+else
+    echo -e "\033[0;31mFAIL\033[0m ${first:-no VERIFY line} / ${second:-no VERIFY line}"
+    FAILURES=$((FAILURES + 1))
+fi
+
+# 2i. C API test program, linked against the static and the shared library
+echo
+echo -n "[API] Running tests/api_test.c against lib/libmatmul.a and lib/libmatmul.so... "
+if (cd "${ROOT}" && make test > "${TMP_DIR}/api_test.log" 2>&1); then
+    echo -e "\033[0;32mPASS\033[0m"
+else
+    echo -e "\033[0;31mFAIL\033[0m"
+    grep -E "FAIL|Error|error" "${TMP_DIR}/api_test.log" || tail -5 "${TMP_DIR}/api_test.log"
+    FAILURES=$((FAILURES + 1))
+fi
+
 # 3. Final summary
 echo
 if [ "$FAILURES" -eq 0 ]; then
@@ -0,0 +1,180 @@
+#include "affinity.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <omp.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace affinity {
+
+static const char *const POLICY_NAMES[] = {"none", "compact", "scatter", "list"};
+
+const char* policy_name(Policy p) { return POLICY_NAMES[int(p)]; }
+
+// "0,2,4-7" into its CPUs, in the given order; false on syntax errors
+static bool parse_cpu_list(const std::string &text, std::vector<int> *out) {
+    out->clear();
+    const char *s = text.c_str();
+    while (*s) {
+        char *end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s || lo < 0) return false;
+        if (*end == '-') {
+            const char *h = end + 1;
+            hi = strtol(h, &end, 10);
+            if (end == h || hi < lo) return false;
+        }
+        for (long c = lo; c <= hi; ++c) out->push_back(int(c));
+        if (*end == '\0') break;
+        if (*end != ',') return false;
+        s = end + 1;
+    }
+    return !out->empty();
+}
+
+bool parse_policy(const std::string &spec, Policy *policy, std::vector<int> *cpus) {
+    for (int i = 0; i < 3; ++i) {
+        if (spec == POLICY_NAMES[i]) { *policy = Policy(i); return true; }
+    }
+    if (!parse_cpu_list(spec, cpus)) return false;
+    *policy = Policy::list;
+    return true;
+}
+
+// Position of one CPU in the machine
+struct CpuInfo {
+    int cpu, node, package, core, smt; // smt: rank among the core's hardware threads
+};
+
+static int read_int(const std::string &path, int fallback) {
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) return fallback;
+    int v = fallback;
+    if (fscanf(f, "%d", &v) != 1) v = fallback;
+    fclose(f);
+    return v;
+}
+
+// NUMA node from the cpuN/nodeM link; 0 without NUMA sysfs
+static int cpu_node(int cpu) {
+    std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR *d = opendir(dir.c_str());
+    if (!d) return 0;
+    int node = 0;
+    while (dirent *e = readdir(d)) {
+        if (strncmp(e->d_name, "node", 4) == 0 && e->d_name[4] >= '0' && e->d_name[4] <= '9') {
+            node = atoi(e->d_name + 4);
+            break;
+        }
+    }
+    closedir(d);
+    return node;
+}
+
+// The CPUs of the process affinity mask with their topology
+static std::vector<CpuInfo> allowed_cpus() {
+    std::vector<CpuInfo> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (!CPU_ISSET(c, &set)) continue;
+        const std::string topo = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        cpus.push_back({c, cpu_node(c), read_int(topo + "physical_package_id", 0),
+                        read_int(topo + "core_id", c), 0});
+    }
+    // SMT rank: order of the CPU ids within each (package, core)
+    std::map<std::pair<int, int>, int> seen;
+    for (CpuInfo &ci : cpus) ci.smt = seen[{ci.package, ci.core}]++;
+    return cpus;
+}
+
+bool plan(Policy policy, const std::vector<int> &list, bool no_smt, int num_threads,
+          std::vector<int> *cpus, bool *shared, std::string *error) {
+    std::vector<CpuInfo> avail = allowed_cpus();
+    std::vector<CpuInfo> order;
+    if (policy == Policy::list) {
+        for (int c : list) {
+            auto it = std::find_if(avail.begin(), avail.end(), [c](const CpuInfo &ci) { return ci.cpu == c; });
+            if (it == avail.end()) {
+                *error = "CPU " + std::to_string(c) + " is offline or outside the allowed set";
+                return false;
+            }
+            order.push_back(*it);
+        }
+    } else {
+        order = avail;
+        if (policy == Policy::compact) {
+            std::sort(order.begin(), order.end(), [](const CpuInfo &a, const CpuInfo &b) {
+                return std::tie(a.package, a.core, a.smt) < std::tie(b.package, b.core, b.smt);
+            });
+        } else {
+            // Scatter: the k-th core of every node before the (k+1)-th of any, SMT ranks last
+            std::map<int, int> rank_in_node;
+            std::map<std::pair<int, int>, int> core_rank; // (package, core) -> rank in its node
+            std::vector<CpuInfo> by_core = order;
+            std::sort(by_core.begin(), by_core.end(), [](const CpuInfo &a, const CpuInfo &b) {
+                return std::tie(a.node, a.package, a.core) < std::tie(b.node, b.package, b.core);
+            });
+            for (const CpuInfo &ci : by_core) {
+                if (!core_rank.count({ci.package, ci.core})) core_rank[{ci.package, ci.core}] = rank_in_node[ci.node]++;
+            }
+            std::sort(order.begin(), order.end(), [&](const CpuInfo &a, const CpuInfo &b) {
+                const int ra = core_rank[{a.package, a.core}], rb = core_rank[{b.package, b.core}];
+                return std::tie(a.smt, ra, a.node, a.cpu) < std::tie(b.smt, rb, b.node, b.cpu);
+            });
+        }
+    }
+    if (no_smt) {
+        std::set<std::pair<int, int>> used;
+        std::vector<CpuInfo> one_per_core;
+        for (const CpuInfo &ci : order) {
+            if (used.insert({ci.package, ci.core}).second) one_per_core.push_back(ci);
+        }
+        order.swap(one_per_core);
+    }
+    if (order.empty()) {
+        *error = "no CPU available";
+        return false;
+    }
+    cpus->clear();
+    for (int t = 0; t < num_threads; ++t) cpus->push_back(order[size_t(t) % order.size()].cpu);
+    *shared = size_t(num_threads) > order.size();
+    return true;
+}
+
+static bool pin_self(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool pin_threads(const std::vector<int> &cpus, int num_threads) {
+    bool ok = true;
+    #pragma omp parallel num_threads(num_threads) reduction(&& : ok)
+    ok = pin_self(cpus[size_t(omp_get_thread_num()) % cpus.size()]);
+    // The main thread is team member 0 and keeps its pin outside parallel regions
+    return ok;
+}
+
+std::vector<int> current_cpus(int num_threads) {
+    std::vector<int> cpus(num_threads, -1);
+    #pragma omp parallel num_threads(num_threads)
+    cpus[omp_get_thread_num()] = sched_getcpu();
+    return cpus;
+}
+
+std::string format_cpus(const std::vector<int> &cpus) {
+    std::string s;
+    for (size_t i = 0; i < cpus.size(); ++i) s += (i ? "," : "") + std::to_string(cpus[i]);
+    return s;
+}
+
+} // namespace affinity
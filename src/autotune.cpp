@@ -0,0 +1,153 @@
+#include "autotune.h"
+#include "dispatch_kernels.h"
+#include "dispatch_kernels_packed.h"
+#include "runner.h"
+#include "runner_packed.h"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+// BLAS-backed modes are the reference, not candidates
+static const char *const BASE_MODES[] = {"avx", "avx_tile", "avx_packed", "hybrid", "interleaved"};
+static const int BLOCK_SIZES[] = {32, 64, 96, 128, 256};
+
+#define HYBRID_TUNED_NAME(a, s) "hybrid<" #a "," #s ">",
+#define INTERLEAVED_TUNED_NAME(a, s) "interleaved<" #a "," #s ">",
+static const char *const HYBRID_GRID_MODES[] = {HYBRID_TUNING_GRID(HYBRID_TUNED_NAME)};
+static const char *const INTERLEAVED_GRID_MODES[] = {INTERLEAVED_TUNING_GRID(INTERLEAVED_TUNED_NAME)};
+
+// Untimed warm-up, then the best of this many timed runs
+constexpr int TUNE_REPEATS = 2;
+
+// Runs one candidate the way main() would and returns its best wall time (< 0 if unusable)
+static double time_candidate(const std::string &mode, int BS, const double *A, const double *B, double *C,
+                             const GemmDims &d, int num_threads) {
+    matmul_func_t block_kernel = get_kernel_for_mode(mode);
+    matmul_packed_func_t packed_kernel = block_kernel ? nullptr : get_kernel_for_mode_packed(mode);
+    if (!block_kernel && (!packed_kernel || num_threads > 1)) return -1.0;
+
+    double best = -1.0;
+    for (int r = 0; r <= TUNE_REPEATS; ++r) {
+        memset(C, 0, sizeof(double) * size_t(d.M) * d.ldc);
+        auto t0 = std::chrono::steady_clock::now();
+        if (packed_kernel) {
+            run_benchmark_packed(A, B, C, d, BS, packed_kernel);
+        } else if (num_threads > 1) {
+            run_benchmark_parallel(A, B, C, d, BS, block_kernel, num_threads);
+        } else {
+            run_benchmark(A, B, C, d, BS, block_kernel);
+        }
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        if (r > 0 && (best < 0.0 || dt.count() < best)) best = dt.count();
+    }
+    fprintf(stderr, "TUNE\tmode=%s\tBS=%d\tbest_s=%g\n", mode.c_str(), BS, best);
+    return best;
+}
+
+bool autotune_search(const double *A, const double *B, double *C, const GemmDims &d,
+                     int num_threads, TunedConfig *best) {
+    const int max_dim = std::max(d.M, std::max(d.N, d.K));
+    std::vector<int> block_sizes;
+    for (int bs : BLOCK_SIZES) {
+        if (bs <= max_dim || block_sizes.empty()) block_sizes.push_back(bs);
+    }
+
+    best->mode.clear();
+    auto consider = [&](const std::string &mode, int BS) {
+        double s = time_candidate(mode, BS, A, B, C, d, num_threads);
+        if (s < 0.0) return s;
+        if (best->mode.empty() || s < best->seconds) {
+            best->mode = mode;
+            best->BS = BS;
+            best->seconds = s;
+        }
+        return s;
+    };
+
+    // Stage 1: BS sweep for every base mode at its default tuning
+    int hybrid_bs = block_sizes[0], interleaved_bs = block_sizes[0];
+    for (const char *mode : BASE_MODES) {
+        double mode_best = -1.0;
+        for (int bs : block_sizes) {
+            double s = consider(mode, bs);
+            if (s >= 0.0 && (mode_best < 0.0 || s < mode_best)) {
+                mode_best = s;
+                if (strcmp(mode, "hybrid") == 0) hybrid_bs = bs;
+                if (strcmp(mode, "interleaved") == 0) interleaved_bs = bs;
+            }
+        }
+    }
+
+    // Stage 2: the tuning grids at the BS their family preferred
+    for (const char *mode : HYBRID_GRID_MODES) consider(mode, hybrid_bs);
+    for (const char *mode : INTERLEAVED_GRID_MODES) consider(mode, interleaved_bs);
+
+    memset(C, 0, sizeof(double) * size_t(d.M) * d.ldc);
+    return !best->mode.empty();
+}
+
+std::string default_tuning_file() {
+    char host[256] = "localhost";
+    if (gethostname(host, sizeof(host)) != 0) strcpy(host, "localhost");
+    host[sizeof(host) - 1] = '\0';
+    return std::string("tuning_") + host + ".tsv";
+}
+
+// One line per tuned problem: M N K isa threads mode BS seconds (tab separated)
+static std::string entry_key(const GemmDims &d, IsaLevel isa, int num_threads) {
+    // The tuned f64 candidates have no avx512_bf16 variants, so that tier shares avx512's entries
+    isa = std::min(isa, IsaLevel::avx512);
+    std::ostringstream key;
+    key << d.M << '\t' << d.N << '\t' << d.K << '\t' << isa_name(isa) << '\t' << num_threads;
+    return key.str();
+}
+
+static std::vector<std::string> read_lines(const std::string &path) {
+    std::vector<std::string> lines;
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) return lines;
+    char buf[512];
+    while (fgets(buf, sizeof(buf), f)) {
+        std::string line(buf);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        if (!line.empty()) lines.push_back(line);
+    }
+    fclose(f);
+    return lines;
+}
+
+bool load_tuned_config(const std::string &path, const GemmDims &d, IsaLevel isa, int num_threads,
+                       TunedConfig *cfg) {
+    const std::string key = entry_key(d, isa, num_threads) + '\t';
+    for (const std::string &line : read_lines(path)) {
+        if (line.compare(0, key.size(), key) != 0) continue;
+        std::istringstream rest(line.substr(key.size()));
+        TunedConfig parsed;
+        if (std::getline(rest, parsed.mode, '\t') && rest >> parsed.BS >> parsed.seconds && parsed.BS > 0) {
+            *cfg = parsed;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool save_tuned_config(const std::string &path, const GemmDims &d, IsaLevel isa, int num_threads,
+                       const TunedConfig &cfg) {
+    const std::string key = entry_key(d, isa, num_threads);
+    std::vector<std::string> lines;
+    for (const std::string &line : read_lines(path)) {
+        if (line.compare(0, key.size() + 1, key + '\t') != 0) lines.push_back(line);
+    }
+    std::ostringstream entry;
+    entry << key << '\t' << cfg.mode << '\t' << cfg.BS << '\t' << cfg.seconds;
+    lines.push_back(entry.str());
+
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    for (const std::string &line : lines) fprintf(f, "%s\n", line.c_str());
+    return fclose(f) == 0;
+}
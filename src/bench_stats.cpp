@@ -0,0 +1,25 @@
+#include "bench_stats.h"
+#include <algorithm>
+#include <cmath>
+
+TimingStats compute_timing_stats(std::vector<double> samples) {
+    TimingStats st;
+    st.count = (int)samples.size();
+    if (samples.empty()) return st;
+    std::sort(samples.begin(), samples.end());
+
+    const int n = st.count;
+    st.min = samples.front();
+    st.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    st.p95 = samples[std::max(0, (int)std::ceil(0.95 * n) - 1)];
+
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    st.mean = sum / n;
+    if (n > 1) {
+        double sq = 0.0;
+        for (double s : samples) sq += (s - st.mean) * (s - st.mean);
+        st.stddev = std::sqrt(sq / (n - 1));
+    }
+    return st;
+}
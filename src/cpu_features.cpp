@@ -0,0 +1,43 @@
+#include "cpu_features.h"
+#include <algorithm>
+
+static IsaLevel isa_limit = IsaLevel::avx512_bf16;
+
+IsaLevel detect_isa() {
+    // __builtin_cpu_supports also checks that the OS saves the wide register state
+    static const IsaLevel detected = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return __builtin_cpu_supports("avx512bf16") ? IsaLevel::avx512_bf16 : IsaLevel::avx512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return IsaLevel::avx2;
+        return IsaLevel::scalar;
+    }();
+    return detected;
+}
+
+void set_isa_limit(IsaLevel limit) {
+    isa_limit = limit;
+}
+
+IsaLevel effective_isa() {
+    return std::min(detect_isa(), isa_limit);
+}
+
+const char* isa_name(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::avx512_bf16: return "avx512_bf16";
+        case IsaLevel::avx512: return "avx512";
+        case IsaLevel::avx2: return "avx2";
+        case IsaLevel::scalar: return "scalar";
+    }
+    return "unknown";
+}
+
+bool parse_isa(const std::string& name, IsaLevel *out) {
+    if (name == "avx512_bf16") { *out = IsaLevel::avx512_bf16; return true; }
+    if (name == "avx512") { *out = IsaLevel::avx512; return true; }
+    if (name == "avx2") { *out = IsaLevel::avx2; return true; }
+    if (name == "scalar") { *out = IsaLevel::scalar; return true; }
+    return false;
+}
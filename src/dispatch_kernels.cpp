@@ -1,21 +1,84 @@
-#include "kernels.h"
+#include "dispatch_kernels.h"
 #include <map>
 #include <string>
+#include <vector>
+
+// Map entries for the tuning grid of kernel_grid.h, e.g. "interleaved<2,8>"
+#define HYBRID_MODE(name, a, s) \
+    {name, {{IsaLevel::avx512, kernel_hybrid_##a##_##s}, \
+            {IsaLevel::avx2, kernel_hybrid_avx2_##a##_##s}, \
+            {IsaLevel::scalar, kernel_scalar}}},
+#define INTERLEAVED_MODE(name, a, s) \
+    {name, {{IsaLevel::avx512, kernel_interleaved_##a##_##s}, \
+            {IsaLevel::avx2, kernel_interleaved_avx2_##a##_##s}, \
+            {IsaLevel::scalar, kernel_scalar}}},
+#define HYBRID_GRID_ENTRY(a, s) HYBRID_MODE("hybrid<" #a "," #s ">", a, s)
+#define INTERLEAVED_GRID_ENTRY(a, s) INTERLEAVED_MODE("interleaved<" #a "," #s ">", a, s)
 
 // The dispatcher function that returns the correct kernel
-matmul_func_t get_kernel_for_mode(const std::string& mode) {
-    // Update the map to point to the newly named functions
-    static const std::map<std::string, matmul_func_t> kernel_map = {
-        {"avx", kernel_avx},
-        {"scalar", kernel_scalar},
-        {"hybrid", kernel_hybrid},
-        {"interleaved", kernel_interleaved},
-        {"blas", kernel_blas}
+matmul_func_t get_kernel_for_mode(const std::string& mode, IsaLevel *chosen) {
+    // Each mode lists its variants best first; kernel_scalar is the portable fallback
+    static const std::map<std::string, std::vector<IsaVariant<matmul_func_t>>> kernel_map = {
+        {"avx", {{IsaLevel::avx512, kernel_avx},
+                 {IsaLevel::avx2, kernel_avx_avx2},
+                 {IsaLevel::scalar, kernel_scalar}}},
+        {"avx_tile", {{IsaLevel::avx512, kernel_avx_tile},
+                      {IsaLevel::avx2, kernel_avx_tile_avx2},
+                      {IsaLevel::scalar, kernel_scalar}}},
+        {"scalar", {{IsaLevel::scalar, kernel_scalar}}},
+        // Prefetch / streaming-store variants; the AVX2 tier has no hints and runs the plain kernels
+        {"avx_pf", {{IsaLevel::avx512, kernel_avx_pf},
+                    {IsaLevel::avx2, kernel_avx_avx2},
+                    {IsaLevel::scalar, kernel_scalar}}},
+        {"avx_nt", {{IsaLevel::avx512, kernel_avx_nt},
+                    {IsaLevel::avx2, kernel_avx_avx2},
+                    {IsaLevel::scalar, kernel_scalar}}},
+        {"interleaved_pf", {{IsaLevel::avx512, kernel_interleaved_pf},
+                            {IsaLevel::avx2, kernel_interleaved_avx2_1_1},
+                            {IsaLevel::scalar, kernel_scalar}}},
+        {"interleaved_nt", {{IsaLevel::avx512, kernel_interleaved_nt},
+                            {IsaLevel::avx2, kernel_interleaved_avx2_1_1},
+                            {IsaLevel::scalar, kernel_scalar}}},
+        // Plain hybrid / interleaved keep their historical default tunings
+        HYBRID_MODE("hybrid", 1, 2)
+        INTERLEAVED_MODE("interleaved", 1, 1)
+        HYBRID_TUNING_GRID(HYBRID_GRID_ENTRY)
+        INTERLEAVED_TUNING_GRID(INTERLEAVED_GRID_ENTRY)
+        // BLAS does its own CPU dispatch
+        {"blas", {{IsaLevel::scalar, kernel_blas}}}
     };
 
     auto it = kernel_map.find(mode);
     if (it != kernel_map.end()) {
-        return it->second;
+        return select_isa_variant<matmul_func_t>(it->second, chosen);
     }
     return nullptr; // Return null if mode is not found
 }
+
+matmul_f32_func_t get_kernel_for_mode_f32(const std::string& mode, IsaLevel *chosen) {
+    static const std::map<std::string, std::vector<IsaVariant<matmul_f32_func_t>>> kernel_map = {
+        {"avx", {{IsaLevel::avx512, kernel_avx_f32},
+                 {IsaLevel::scalar, kernel_scalar_f32}}},
+        {"scalar", {{IsaLevel::scalar, kernel_scalar_f32}}}
+    };
+
+    auto it = kernel_map.find(mode);
+    if (it != kernel_map.end()) {
+        return select_isa_variant<matmul_f32_func_t>(it->second, chosen);
+    }
+    return nullptr;
+}
+
+matmul_bf16_func_t get_kernel_for_mode_bf16(const std::string& mode, IsaLevel *chosen) {
+    static const std::map<std::string, std::vector<IsaVariant<matmul_bf16_func_t>>> kernel_map = {
+        {"avx", {{IsaLevel::avx512_bf16, kernel_avx_bf16},
+                 {IsaLevel::scalar, kernel_scalar_bf16}}},
+        {"scalar", {{IsaLevel::scalar, kernel_scalar_bf16}}}
+    };
+
+    auto it = kernel_map.find(mode);
+    if (it != kernel_map.end()) {
+        return select_isa_variant<matmul_bf16_func_t>(it->second, chosen);
+    }
+    return nullptr;
+}
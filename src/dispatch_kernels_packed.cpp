@@ -0,0 +1,18 @@
+#include "dispatch_kernels_packed.h"
+#include <map>
+#include <string>
+#include <vector>
+
+matmul_packed_func_t get_kernel_for_mode_packed(const std::string& mode, IsaLevel *chosen) {
+    static const std::map<std::string, std::vector<IsaVariant<matmul_packed_func_t>>> kernel_map = {
+        {"avx_packed", {{IsaLevel::avx512, kernel_avx_packed},
+                        {IsaLevel::scalar, kernel_scalar_packed}}},
+        {"scalar_packed", {{IsaLevel::scalar, kernel_scalar_packed}}}
+    };
+
+    auto it = kernel_map.find(mode);
+    if (it != kernel_map.end()) {
+        return select_isa_variant<matmul_packed_func_t>(it->second, chosen);
+    }
+    return nullptr;
+}
@@ -5,7 +5,9 @@
 matmul_whole_func_t get_kernel_for_mode_whole(const std::string& mode) {
     static const std::map<std::string, matmul_whole_func_t> kernel_map = {
         {"scalar_whole", kernel_scalar_whole},
-        {"blas_whole", kernel_blas_whole}
+        {"blas_whole", kernel_blas_whole},
+        {"strassen", kernel_strassen_whole},
+        {"morton", kernel_morton_whole}
     };
 
     auto it = kernel_map.find(mode);
@@ -0,0 +1,123 @@
+#include "energy.h"
+#include <dirent.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifndef RAPL_POWERCAP_ROOT
+#define RAPL_POWERCAP_ROOT "/sys/class/powercap"
+#endif
+
+namespace energy {
+
+static bool read_line(const std::string &path, std::string *out) {
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    char buf[128];
+    const bool ok = fgets(buf, sizeof(buf), f) != nullptr;
+    fclose(f);
+    if (!ok) return false;
+    *out = buf;
+    while (!out->empty() && (out->back() == '\n' || out->back() == '\r')) out->pop_back();
+    return true;
+}
+
+static bool read_u64(const std::string &path, uint64_t *v) {
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    unsigned long long x = 0;
+    const bool ok = fscanf(f, "%llu", &x) == 1;
+    fclose(f);
+    if (ok) *v = x;
+    return ok;
+}
+
+// Zone directories named prefix + "<n>" (no further ':'), sorted so package-0 comes first
+static std::vector<std::string> zones(const std::string &dir, const std::string &prefix) {
+    std::vector<std::string> out;
+    DIR *d = opendir(dir.c_str());
+    if (!d) return out;
+    while (dirent *e = readdir(d)) {
+        const std::string name = e->d_name;
+        if (name.compare(0, prefix.size(), prefix) != 0 || name.size() == prefix.size()) continue;
+        if (name.find_first_not_of("0123456789", prefix.size()) != std::string::npos) continue;
+        out.push_back(name);
+    }
+    closedir(d);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+static void add_domain(const std::string &dir, const std::string &name, bool dram,
+                       std::vector<Domain> *domains) {
+    Domain dom;
+    dom.name = name;
+    dom.file = dir + "/energy_uj";
+    dom.dram = dram;
+    if (!read_u64(dir + "/max_energy_range_uj", &dom.max_uj)) dom.max_uj = 0;
+    domains->push_back(dom);
+}
+
+bool discover(std::vector<Domain> *domains, std::string *error) {
+    domains->clear();
+    const std::string root = RAPL_POWERCAP_ROOT;
+    for (const std::string &pkg : zones(root, "intel-rapl:")) {
+        const std::string dir = root + "/" + pkg;
+        std::string name;
+        if (!read_line(dir + "/name", &name) || name.compare(0, 7, "package") != 0) continue;
+        add_domain(dir, name, false, domains);
+        for (const std::string &sub : zones(dir, pkg + ":")) {
+            std::string sub_name;
+            if (read_line(dir + "/" + sub + "/name", &sub_name) && sub_name == "dram") {
+                add_domain(dir + "/" + sub, name + "/dram", true, domains);
+            }
+        }
+    }
+    if (domains->empty()) {
+        *error = "no RAPL package zones under " + root;
+        return false;
+    }
+    for (const Domain &dom : *domains) {
+        uint64_t v;
+        if (!read_u64(dom.file, &v)) {
+            *error = dom.file + ": " + strerror(errno);
+            domains->clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool read_uj(const std::vector<Domain> &domains, std::vector<uint64_t> *uj) {
+    uj->resize(domains.size());
+    for (size_t i = 0; i < domains.size(); ++i) {
+        if (!read_u64(domains[i].file, &(*uj)[i])) return false;
+    }
+    return true;
+}
+
+Energy consumed(const std::vector<Domain> &domains, const std::vector<uint64_t> &before,
+                const std::vector<uint64_t> &after) {
+    Energy e;
+    for (size_t i = 0; i < domains.size() && i < before.size() && i < after.size(); ++i) {
+        uint64_t delta = after[i] - before[i];
+        if (after[i] < before[i]) delta = domains[i].max_uj - before[i] + after[i];
+        const double joules = double(delta) * 1e-6;
+        if (domains[i].dram) {
+            e.dram_joules += joules;
+            e.have_dram = true;
+        } else {
+            e.package_joules += joules;
+        }
+    }
+    return e;
+}
+
+std::string format_domains(const std::vector<Domain> &domains) {
+    std::string out;
+    for (size_t i = 0; i < domains.size(); ++i) out += (i ? "," : "") + domains[i].name;
+    return out;
+}
+
+} // namespace energy
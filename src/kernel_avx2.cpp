@@ -0,0 +1,131 @@
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+// AVX2/FMA3 (256-bit) ports of the avx and avx_tile block kernels, selected by the
+// dispatcher on hosts without AVX-512. Same packed layouts and edge semantics as
+// the AVX-512 versions; partial strips use _mm256_maskload/maskstore.
+
+#ifndef AVX2_TILE_MR
+#define AVX2_TILE_MR 4
+#endif
+
+#ifndef AVX2_TILE_NR
+#define AVX2_TILE_NR 12
+#endif
+
+constexpr int AVX2_STEP_SIZE = 4;
+constexpr int AVX2_TILE_NR_VECS = AVX2_TILE_NR / AVX2_STEP_SIZE;
+
+static_assert(AVX2_TILE_MR > 0, "AVX2_TILE_MR must be positive");
+static_assert(AVX2_TILE_NR > 0 && AVX2_TILE_NR % AVX2_STEP_SIZE == 0, "AVX2_TILE_NR must be a positive multiple of 4");
+// MR*NV accumulators + NV B vectors + 1 broadcast must fit in the 16 ymm registers
+static_assert(AVX2_TILE_MR * AVX2_TILE_NR_VECS + AVX2_TILE_NR_VECS + 1 <= 16, "MR x NR tile does not fit in the ymm register file");
+
+// Lane mask selecting the first n (1..4) doubles of a ymm vector
+static inline __m256i lane_mask(int n) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+extern "C" void kernel_avx_avx2(const double *packA, const double *packB, double *C,
+                                int M, int N, int K, int ldc, int i0, int j0, int k0, int bs)
+{
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        for (int j_off = 0; j_off < nb; j_off += AVX2_STEP_SIZE) {
+            __m256i mask = lane_mask(std::min(AVX2_STEP_SIZE, nb - j_off));
+            __m256d cvec = _mm256_maskload_pd(&C[i * ldc + (j0 + j_off)], mask);
+            const double *packA_row = &packA[ii * bs];
+            for (int kk = 0; kk < kb; ++kk) {
+                __m256d bvec = _mm256_maskload_pd(&packB[kk * bs + j_off], mask);
+                __m256d avec = _mm256_set1_pd(packA_row[kk]);
+                cvec = _mm256_fmadd_pd(avec, bvec, cvec);
+            }
+            _mm256_maskstore_pd(&C[i * ldc + (j0 + j_off)], mask, cvec);
+        }
+    }
+}
+
+// MR x (NV*4) register tile; with MASKED the last vector only covers the lanes in tail.
+template <int MR, int NV, bool MASKED>
+static inline void micro_tile(const double *packA, const double *packB, double *C,
+                              int ldc, int i0, int j0, int bs, int kb, int ii, int jj, __m256i tail) {
+    __m256d cvecs[MR][NV];
+
+    for (int r = 0; r < MR; ++r) {
+        for (int v = 0; v < NV; ++v) {
+            const double *cptr = &C[(i0 + ii + r) * ldc + j0 + jj + v * AVX2_STEP_SIZE];
+            cvecs[r][v] = (MASKED && v == NV - 1) ? _mm256_maskload_pd(cptr, tail) : _mm256_loadu_pd(cptr);
+        }
+    }
+
+    for (int kk = 0; kk < kb; ++kk) {
+        __m256d bvecs[NV];
+        for (int v = 0; v < NV; ++v) {
+            const double *bptr = &packB[kk * bs + jj + v * AVX2_STEP_SIZE];
+            bvecs[v] = (MASKED && v == NV - 1) ? _mm256_maskload_pd(bptr, tail) : _mm256_loadu_pd(bptr);
+        }
+        for (int r = 0; r < MR; ++r) {
+            __m256d avec = _mm256_set1_pd(packA[(ii + r) * bs + kk]);
+            for (int v = 0; v < NV; ++v) {
+                cvecs[r][v] = _mm256_fmadd_pd(avec, bvecs[v], cvecs[r][v]);
+            }
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        for (int v = 0; v < NV; ++v) {
+            double *cptr = &C[(i0 + ii + r) * ldc + j0 + jj + v * AVX2_STEP_SIZE];
+            if (MASKED && v == NV - 1) {
+                _mm256_maskstore_pd(cptr, tail, cvecs[r][v]);
+            } else {
+                _mm256_storeu_pd(cptr, cvecs[r][v]);
+            }
+        }
+    }
+}
+
+template <int MR, int NV>
+static inline void micro_tile_tail(int nv, const double *packA, const double *packB, double *C,
+                                   int ldc, int i0, int j0, int bs, int kb, int ii, int jj, __m256i tail) {
+    if constexpr (NV > 0) {
+        if (nv == NV) {
+            micro_tile<MR, NV, true>(packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, tail);
+        } else {
+            micro_tile_tail<MR, NV - 1>(nv, packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, tail);
+        }
+    }
+}
+
+template <int MR>
+static inline void row_strip(const double *packA, const double *packB, double *C,
+                             int ldc, int i0, int j0, int bs, int nb, int kb, int ii) {
+    int jj = 0;
+    for (; jj + AVX2_TILE_NR <= nb; jj += AVX2_TILE_NR) {
+        micro_tile<MR, AVX2_TILE_NR_VECS, false>(packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, lane_mask(4));
+    }
+    int rem = nb - jj;
+    if (rem > 0) {
+        int nv = (rem + AVX2_STEP_SIZE - 1) / AVX2_STEP_SIZE;
+        __m256i tail = lane_mask(rem - (nv - 1) * AVX2_STEP_SIZE);
+        micro_tile_tail<MR, AVX2_TILE_NR_VECS>(nv, packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, tail);
+    }
+}
+
+extern "C" void kernel_avx_tile_avx2(const double *packA, const double *packB, double *C,
+                                     int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    int ii = 0;
+    for (; ii + AVX2_TILE_MR <= mb; ii += AVX2_TILE_MR) {
+        row_strip<AVX2_TILE_MR>(packA, packB, C, ldc, i0, j0, bs, nb, kb, ii);
+    }
+    for (; ii < mb; ++ii) {
+        row_strip<1>(packA, packB, C, ldc, i0, j0, bs, nb, kb, ii);
+    }
+}
@@ -0,0 +1,35 @@
+#include "dtype.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+// BF16 x BF16 -> FP32 block kernel on AVX512_BF16. vdpbf16ps multiplies 32 bf16 pairs and
+// adds each pair's two products into one of 16 float lanes, so one instruction covers two
+// k steps of a 16-column strip: the broadcast holds (A[ii][kk], A[ii][kk+1]) and the packed
+// B row pair holds (B[kk][j], B[kk+1][j]) for 16 consecutive j (kernels.h layout).
+extern "C" void kernel_avx_bf16(const bf16_t *packA, const bf16_t *packB, float *C,
+                                int M, int N, int K, int ldc, int i0, int j0, int k0, int bs)
+{
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    const int kpairs = (kb + 1) / 2; // an odd tail pairs with the zero padding of the packers
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        const bf16_t *packA_row = &packA[ii * bs];
+        for (int j_off = 0; j_off < nb; j_off += 16) {
+            // one 32-bit lane per column (a bf16 pair) in the packed B rows
+            __mmask16 mask = (__mmask16)((1u << std::min(16, nb - j_off)) - 1);
+            __m512 cvec = _mm512_maskz_loadu_ps(mask, &C[i * ldc + (j0 + j_off)]);
+            for (int p = 0; p < kpairs; ++p) {
+                uint32_t apair;
+                memcpy(&apair, &packA_row[2 * p], sizeof(apair));
+                __m512i avec = _mm512_set1_epi32(int(apair));
+                __m512i bvec = _mm512_maskz_loadu_epi32(mask, &packB[p * 2 * bs + 2 * j_off]);
+                cvec = _mm512_dpbf16_ps(cvec, (__m512bh)avec, (__m512bh)bvec);
+            }
+            _mm512_mask_storeu_ps(&C[i * ldc + (j0 + j_off)], mask, cvec);
+        }
+    }
+}
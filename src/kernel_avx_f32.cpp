@@ -0,0 +1,28 @@
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+// Single-precision (sgemm-style) port of kernel_avx: 16 floats per zmm register.
+extern "C" void kernel_avx_f32(const float *packA, const float *packB, float *C,
+                               int M, int N, int K, int ldc, int i0, int j0, int k0, int bs)
+{
+    // packA layout: packA[ii*bs + kk], packB layout: packB[kk*bs + jj] (see kernels.h)
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        for (int j_off = 0; j_off < nb; j_off += 16) {
+            // the last strip may be narrower than 16 columns: mask its lanes
+            __mmask16 mask = (__mmask16)((1u << std::min(16, nb - j_off)) - 1);
+            __m512 cvec = _mm512_maskz_loadu_ps(mask, &C[i * ldc + (j0 + j_off)]);
+            const float *packA_row = &packA[ii * bs];
+            for (int kk = 0; kk < kb; ++kk) {
+                __m512 bvec = _mm512_maskz_loadu_ps(mask, &packB[kk * bs + j_off]);
+                __m512 avec = _mm512_set1_ps(packA_row[kk]);
+                cvec = _mm512_fmadd_ps(avec, bvec, cvec);
+            }
+            _mm512_mask_storeu_ps(&C[i * ldc + (j0 + j_off)], mask, cvec);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#include "kernels_packed.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+// Register-blocked AVX-512 kernel over panel-major operands (see kernels_packed.h).
+// Both the MR broadcasts of A and the NR-wide vectors of B for each kk are contiguous,
+// so the k loop streams two sequential pointers instead of striding by bs.
+
+constexpr int AVX_STEP_SIZE = 8;
+constexpr int PACK_NR_VECS = PACK_NR / AVX_STEP_SIZE;
+
+static_assert(PACK_MR * PACK_NR_VECS + PACK_NR_VECS + 1 <= 32, "MR x NR tile does not fit in the zmm register file");
+
+// MR x (NV*8) tile of C from one A sliver (MR rows) and one B sliver of width w
+// (NV vectors; when w is not a multiple of 8 the last vector is masked by tail).
+template <int MR, int NV>
+static inline void packed_tile(const double *asliver, const double *bsliver, double *C,
+                               int ldc, int i, int j, int kb, int w, __mmask8 tail) {
+    __m512d cvecs[MR][NV];
+
+    for (int r = 0; r < MR; ++r) {
+        for (int v = 0; v < NV - 1; ++v) {
+            cvecs[r][v] = _mm512_loadu_pd(&C[(i + r) * ldc + j + v * AVX_STEP_SIZE]);
+        }
+        cvecs[r][NV - 1] = _mm512_maskz_loadu_pd(tail, &C[(i + r) * ldc + j + (NV - 1) * AVX_STEP_SIZE]);
+    }
+
+    for (int kk = 0; kk < kb; ++kk) {
+        __m512d bvecs[NV];
+        for (int v = 0; v < NV - 1; ++v) {
+            bvecs[v] = _mm512_loadu_pd(&bsliver[kk * w + v * AVX_STEP_SIZE]);
+        }
+        bvecs[NV - 1] = _mm512_maskz_loadu_pd(tail, &bsliver[kk * w + (NV - 1) * AVX_STEP_SIZE]);
+        for (int r = 0; r < MR; ++r) {
+            __m512d avec = _mm512_set1_pd(asliver[kk * MR + r]);
+            for (int v = 0; v < NV; ++v) {
+                cvecs[r][v] = _mm512_fmadd_pd(avec, bvecs[v], cvecs[r][v]);
+            }
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        for (int v = 0; v < NV - 1; ++v) {
+            _mm512_storeu_pd(&C[(i + r) * ldc + j + v * AVX_STEP_SIZE], cvecs[r][v]);
+        }
+        _mm512_mask_storeu_pd(&C[(i + r) * ldc + j + (NV - 1) * AVX_STEP_SIZE], tail, cvecs[r][NV - 1]);
+    }
+}
+
+// Selects the instantiation matching a partial B sliver (nv vectors wide).
+template <int MR, int NV>
+static inline void packed_tile_cols(int nv, const double *asliver, const double *bsliver, double *C,
+                                    int ldc, int i, int j, int kb, int w, __mmask8 tail) {
+    if constexpr (NV > 0) {
+        if (nv == NV) {
+            packed_tile<MR, NV>(asliver, bsliver, C, ldc, i, j, kb, w, tail);
+        } else {
+            packed_tile_cols<MR, NV - 1>(nv, asliver, bsliver, C, ldc, i, j, kb, w, tail);
+        }
+    }
+}
+
+// Selects the instantiation matching a partial A sliver (h rows).
+template <int MR>
+static inline void packed_tile_rows(int h, int nv, const double *asliver, const double *bsliver, double *C,
+                                    int ldc, int i, int j, int kb, int w, __mmask8 tail) {
+    if constexpr (MR > 0) {
+        if (h == MR) {
+            packed_tile_cols<MR, PACK_NR_VECS>(nv, asliver, bsliver, C, ldc, i, j, kb, w, tail);
+        } else {
+            packed_tile_rows<MR - 1>(h, nv, asliver, bsliver, C, ldc, i, j, kb, w, tail);
+        }
+    }
+}
+
+extern "C" void kernel_avx_packed(const double *packA, const double *packB, double *C,
+                                  int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ii += PACK_MR) {
+        int h = std::min(PACK_MR, mb - ii);
+        const double *asliver = &packA[ii * bs];
+        for (int jj = 0; jj < nb; jj += PACK_NR) {
+            int w = std::min(PACK_NR, nb - jj);
+            int nv = (w + AVX_STEP_SIZE - 1) / AVX_STEP_SIZE;
+            __mmask8 tail = (__mmask8)((1u << (w - (nv - 1) * AVX_STEP_SIZE)) - 1);
+            const double *bsliver = &packB[jj * bs];
+            packed_tile_rows<PACK_MR>(h, nv, asliver, bsliver, C, ldc, i0 + ii, j0 + jj, kb, w, tail);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "kernel_stream.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+// kernel_avx with memory hints (see kernel_stream.h): software prefetch of the packB rows
+// ahead and of the next C tile, and with STREAM non-temporal stores of the C rows on the
+// final k-panel (k0 + bs >= K), followed by an sfence so the data is globally visible when
+// the runner moves on.
+template <bool STREAM>
+static inline void kernel_avx_hinted(const double *packA, const double *packB, double *C,
+                                     int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    const bool stream = STREAM && k0 + bs >= K;
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        double *c_row = &C[i * ldc];
+        for (int j_off = 0; j_off < nb; j_off += 8) {
+            prefetch_next_c_tile(c_row, j0, j_off, bs, N);
+            // the last strip may be narrower than 8 columns: mask its lanes
+            const int width = std::min(8, nb - j_off);
+            __mmask8 mask = (__mmask8)((1u << width) - 1);
+            __m512d cvec = _mm512_maskz_loadu_pd(mask, &c_row[j0 + j_off]);
+            const double *packA_row = &packA[ii * bs];
+            for (int kk = 0; kk < kb; ++kk) {
+                const double *brow = &packB[kk * bs + j_off];
+                prefetch_packB_row(brow, bs);
+                __m512d bvec = _mm512_maskz_loadu_pd(mask, brow);
+                __m512d avec = _mm512_set1_pd(packA_row[kk]);
+                cvec = _mm512_fmadd_pd(avec, bvec, cvec);
+            }
+            if (width == 8) {
+                store_c_full(&c_row[j0 + j_off], cvec, stream);
+            } else {
+                _mm512_mask_storeu_pd(&c_row[j0 + j_off], mask, cvec);
+            }
+        }
+    }
+    if (stream) _mm_sfence();
+}
+
+extern "C" void kernel_avx_pf(const double *packA, const double *packB, double *C,
+                              int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    kernel_avx_hinted<false>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);
+}
+
+extern "C" void kernel_avx_nt(const double *packA, const double *packB, double *C,
+                              int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    kernel_avx_hinted<true>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);
+}
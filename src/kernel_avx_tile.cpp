@@ -0,0 +1,111 @@
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+// Register-blocked AVX-512 micro-kernel.
+// An MR x NR tile of C is kept in zmm registers across the whole kk loop, so
+// every packB vector loaded feeds MR FMAs and C is touched once per k-block.
+
+#ifndef AVX_TILE_MR
+#define AVX_TILE_MR 8
+#endif
+
+#ifndef AVX_TILE_NR
+#define AVX_TILE_NR 24
+#endif
+
+constexpr int AVX_STEP_SIZE = 8;
+constexpr int TILE_NR_VECS = AVX_TILE_NR / AVX_STEP_SIZE;
+
+static_assert(AVX_TILE_MR > 0, "AVX_TILE_MR must be positive");
+static_assert(AVX_TILE_NR > 0 && AVX_TILE_NR % AVX_STEP_SIZE == 0, "AVX_TILE_NR must be a positive multiple of 8");
+// MR*NV accumulators + NV B vectors + 1 broadcast must fit in the 32 zmm registers
+static_assert(AVX_TILE_MR * TILE_NR_VECS + TILE_NR_VECS + 1 <= 32, "MR x NR tile does not fit in the zmm register file");
+
+// Computes C[ii..ii+MR) x [jj..jj+NV*8) of the current block over the k-block.
+// With MASKED, only the lanes of the last vector selected by tail are loaded/stored.
+template <int MR, int NV, bool MASKED>
+static inline void micro_tile(const double *packA, const double *packB, double *C,
+                              int ldc, int i0, int j0, int bs, int kb, int ii, int jj, __mmask8 tail) {
+    __m512d cvecs[MR][NV];
+
+    for (int r = 0; r < MR; ++r) {
+        for (int v = 0; v < NV; ++v) {
+            const double *cptr = &C[(i0 + ii + r) * ldc + j0 + jj + v * AVX_STEP_SIZE];
+            cvecs[r][v] = (MASKED && v == NV - 1) ? _mm512_maskz_loadu_pd(tail, cptr) : _mm512_loadu_pd(cptr);
+        }
+    }
+
+    for (int kk = 0; kk < kb; ++kk) {
+        __m512d bvecs[NV];
+        for (int v = 0; v < NV; ++v) {
+            const double *bptr = &packB[kk * bs + jj + v * AVX_STEP_SIZE];
+            bvecs[v] = (MASKED && v == NV - 1) ? _mm512_maskz_loadu_pd(tail, bptr) : _mm512_loadu_pd(bptr);
+        }
+        for (int r = 0; r < MR; ++r) {
+            __m512d avec = _mm512_set1_pd(packA[(ii + r) * bs + kk]);
+            for (int v = 0; v < NV; ++v) {
+                cvecs[r][v] = _mm512_fmadd_pd(avec, bvecs[v], cvecs[r][v]);
+            }
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        for (int v = 0; v < NV; ++v) {
+            double *cptr = &C[(i0 + ii + r) * ldc + j0 + jj + v * AVX_STEP_SIZE];
+            if (MASKED && v == NV - 1) {
+                _mm512_mask_storeu_pd(cptr, tail, cvecs[r][v]);
+            } else {
+                _mm512_storeu_pd(cptr, cvecs[r][v]);
+            }
+        }
+    }
+}
+
+// Picks the narrower, masked tile instantiation for the column remainder (nv < NR/8 vectors,
+// the last of which may be partial).
+template <int MR, int NV>
+static inline void micro_tile_tail(int nv, const double *packA, const double *packB, double *C,
+                                   int ldc, int i0, int j0, int bs, int kb, int ii, int jj, __mmask8 tail) {
+    if constexpr (NV > 0) {
+        if (nv == NV) {
+            micro_tile<MR, NV, true>(packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, tail);
+        } else {
+            micro_tile_tail<MR, NV - 1>(nv, packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, tail);
+        }
+    }
+}
+
+// Processes one row-strip of MR rows across the nb valid columns of the block.
+template <int MR>
+static inline void row_strip(const double *packA, const double *packB, double *C,
+                             int ldc, int i0, int j0, int bs, int nb, int kb, int ii) {
+    int jj = 0;
+    for (; jj + AVX_TILE_NR <= nb; jj += AVX_TILE_NR) {
+        micro_tile<MR, TILE_NR_VECS, false>(packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, 0xFF);
+    }
+    int rem = nb - jj;
+    if (rem > 0) {
+        int nv = (rem + AVX_STEP_SIZE - 1) / AVX_STEP_SIZE;
+        int last = rem - (nv - 1) * AVX_STEP_SIZE;
+        __mmask8 tail = (__mmask8)((1u << last) - 1);
+        micro_tile_tail<MR, TILE_NR_VECS>(nv, packA, packB, C, ldc, i0, j0, bs, kb, ii, jj, tail);
+    }
+}
+
+extern "C" void kernel_avx_tile(const double *packA, const double *packB, double *C,
+                                int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    // packA layout: packA[ii*bs + kk], packB layout: packB[kk*bs + jj] (same as kernel_avx)
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    int ii = 0;
+    for (; ii + AVX_TILE_MR <= mb; ii += AVX_TILE_MR) {
+        row_strip<AVX_TILE_MR>(packA, packB, C, ldc, i0, j0, bs, nb, kb, ii);
+    }
+    // Leftover rows when mb is not a multiple of MR
+    for (; ii < mb; ++ii) {
+        row_strip<1>(packA, packB, C, ldc, i0, j0, bs, nb, kb, ii);
+    }
+}
@@ -1,4 +1,5 @@
 #include "kernels.h"
+#include <algorithm>
 
 // BLAS dgemm is often implemented in Fortran, so we declare it with C linkage
 // to handle potential name mangling (e.g., dgemm -> dgemm_).
@@ -10,13 +11,16 @@ extern "C" {
 
 // Our C++ wrapper that calls the BLAS dgemm function.
 extern "C" void kernel_blas(const double *packA, const double *packB, double *C,
-                                    int N, int i0, int j0, int k0, int bs) {
+                                    int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
     char trans = 'N';
     double alpha = 1.0;
     double beta = 1.0; // Accumulate onto existing C values
 
-    // We are multiplying two bs x bs packed matrices.
-    // The leading dimension (LDA/LDB) of the packed blocks is 'bs'.
-    // The result is written into a sub-block of C, which has a leading dimension of 'N'.
-    dgemm_(&trans, &trans, &bs, &bs, &bs, &alpha, packB, &bs, packA, &bs, &beta, &C[i0 * N + j0], &N);
+    // We are multiplying two packed blocks, mb x kb (A) and kb x nb (B); edge blocks
+    // are smaller than bs x bs. The leading dimension (LDA/LDB) of the packed blocks is 'bs'.
+    // The result is written into a sub-block of C, which has a leading dimension of 'ldc'.
+    int mb = std::min(bs, M - i0);
+    int nb = std::min(bs, N - j0);
+    int kb = std::min(bs, K - k0);
+    dgemm_(&trans, &trans, &nb, &mb, &kb, &alpha, packB, &bs, packA, &bs, &beta, &C[i0 * ldc + j0], &ldc);
 }
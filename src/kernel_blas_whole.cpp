@@ -7,12 +7,13 @@ extern "C" {
 }
 
 // This kernel makes a single, efficient call to BLAS dgemm for the entire matrix.
-extern "C" void kernel_blas_whole(const double *A, const double *B, double *C, int N) {
+extern "C" void kernel_blas_whole(const double *A, const double *B, double *C,
+                                  int M, int N, int K, int lda, int ldb, int ldc) {
     char trans = 'N';
     double alpha = 1.0;
     double beta = 0.0; // Overwrite C with the result
 
-    // For row-major C=A*B, we ask BLAS to compute C=alpha*B*A + beta*C 
-    // since BLAS is column-major.
-    dgemm_(&trans, &trans, &N, &N, &N, &alpha, B, &N, A, &N, &beta, C, &N);
+    // For row-major C=A*B, we ask BLAS to compute C=alpha*B*A + beta*C
+    // since BLAS is column-major (so the roles of M and N swap).
+    dgemm_(&trans, &trans, &N, &M, &K, &alpha, B, &ldb, A, &lda, &beta, C, &ldc);
 }
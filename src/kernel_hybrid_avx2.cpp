@@ -0,0 +1,91 @@
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+#include "kernel_grid.h"
+
+// AVX2/FMA3 counterpart of kernel_hybrid.cpp for hosts without AVX-512. The grid keeps
+// counting vector ops, so with 256-bit vectors one AVX op covers 4 columns.
+constexpr int AVX_STEP_SIZE = 4; // doubles per ymm vector
+
+// Updates the mb x nb block of C at (i0, j0) over kb k-steps in chunks of AVX_OPS vector
+// columns followed by SCALAR_OPS scalar columns. With BS > 0 the block is known to be full
+// (mb == nb == kb == bs == BS), so every trip count is a compile-time constant.
+// Lane mask selecting the first n (1..4) doubles of a ymm vector
+static inline __m256i lane_mask(int n) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+template <int AVX_OPS, int SCALAR_OPS, int BS>
+static inline void hybrid_block(const double *packA, const double *packB, double *C, int ldc,
+                                int i0, int j0, int mb_rt, int nb_rt, int kb_rt, int bs_rt) {
+    constexpr int TOTAL_STEP_SIZE = (AVX_OPS * AVX_STEP_SIZE) + SCALAR_OPS;
+    static_assert(TOTAL_STEP_SIZE > 0, "hybrid needs at least one AVX or scalar op");
+    const int bs = BS > 0 ? BS : bs_rt;
+    const int mb = BS > 0 ? BS : mb_rt;
+    const int nb = BS > 0 ? BS : nb_rt;
+    const int kb = BS > 0 ? BS : kb_rt;
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        int j_off = 0;
+
+        // Main loop for full chunks that are guaranteed to be within bounds
+        for (; j_off + TOTAL_STEP_SIZE <= nb; j_off += TOTAL_STEP_SIZE) {
+            // --- AVX Part (Now safe to execute) ---
+            for (int avx_idx = 0; avx_idx < AVX_OPS; ++avx_idx) {
+                int current_j_avx = j_off + avx_idx * AVX_STEP_SIZE;
+                __m256d cvec = _mm256_loadu_pd(&C[i * ldc + j0 + current_j_avx]);
+                for (int kk = 0; kk < kb; ++kk) {
+                    __m256d avec = _mm256_set1_pd(packA[ii * bs + kk]);
+                    __m256d bvec = _mm256_loadu_pd(&packB[kk * bs + current_j_avx]);
+                    cvec = _mm256_fmadd_pd(avec, bvec, cvec);
+                }
+                _mm256_storeu_pd(&C[i * ldc + j0 + current_j_avx], cvec);
+            }
+
+            // --- Scalar Part (Now safe to execute) ---
+            int scalar_start_offset = AVX_OPS * AVX_STEP_SIZE;
+            for (int scalar_idx = 0; scalar_idx < SCALAR_OPS; ++scalar_idx) {
+                int current_j_scalar = j_off + scalar_start_offset + scalar_idx;
+                double sum = C[i * ldc + j0 + current_j_scalar];
+                for (int kk = 0; kk < kb; ++kk) {
+                    sum += packA[ii * bs + kk] * packB[kk * bs + current_j_scalar];
+                }
+                C[i * ldc + j0 + current_j_scalar] = sum;
+            }
+        }
+
+        // --- Cleanup Loop ---
+        // Process the remaining columns in 4-wide strips, masking the lanes past nb.
+        for (; j_off < nb; j_off += AVX_STEP_SIZE) {
+            __m256i mask = lane_mask(std::min(AVX_STEP_SIZE, nb - j_off));
+            __m256d cvec = _mm256_maskload_pd(&C[i * ldc + j0 + j_off], mask);
+            for (int kk = 0; kk < kb; ++kk) {
+                __m256d avec = _mm256_set1_pd(packA[ii * bs + kk]);
+                __m256d bvec = _mm256_maskload_pd(&packB[kk * bs + j_off], mask);
+                cvec = _mm256_fmadd_pd(avec, bvec, cvec);
+            }
+            _mm256_maskstore_pd(&C[i * ldc + j0 + j_off], mask, cvec);
+        }
+    }
+}
+
+template <int AVX_OPS, int SCALAR_OPS>
+static inline void kernel_hybrid_t(const double *packA, const double *packB, double *C,
+                                   int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    const bool full = mb == bs && nb == bs && kb == bs;
+    with_block_size<HYBRID_GRID_BLOCK_SIZES>(full ? bs : 0, [&](auto block) {
+        hybrid_block<AVX_OPS, SCALAR_OPS, decltype(block)::value>(packA, packB, C, ldc, i0, j0, mb, nb, kb, bs);
+    });
+}
+
+#define DEFINE_KERNEL_HYBRID_AVX2(a, s)                                                                          \
+    extern "C" void kernel_hybrid_avx2_##a##_##s(const double *packA, const double *packB, double *C,            \
+                                                 int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) { \
+        kernel_hybrid_t<a, s>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);                                    \
+    }
+HYBRID_TUNING_GRID(DEFINE_KERNEL_HYBRID_AVX2)
@@ -1,72 +1,135 @@
 #include <immintrin.h>
+#include <algorithm>
 #include <cstddef>
 
-#ifndef INTERLEAVED_AVX_OPS
-#define INTERLEAVED_AVX_OPS 1
-#endif
-
-#ifndef INTERLEAVED_SCALAR_OPS
-#define INTERLEAVED_SCALAR_OPS 1
-#endif
+#include "kernel_grid.h"
+#include "kernel_stream.h"
 
 constexpr int AVX_STEP_SIZE = 8;
 constexpr int SCALAR_STEP_SIZE = 1;
-constexpr int TOTAL_STEP_SIZE = (INTERLEAVED_AVX_OPS * AVX_STEP_SIZE) + (INTERLEAVED_SCALAR_OPS * SCALAR_STEP_SIZE);
 
-extern "C" void kernel_interleaved(const double *packA, const double *packB, double *C,
-                                   int N, int i0, int j0, int k0, int bs) {
-    for (int ii = 0; ii < bs; ++ii) {
+// Memory hints of the interleaved_pf / interleaved_nt variants (see kernel_stream.h)
+enum Hints { HINTS_NONE, HINTS_PREFETCH, HINTS_PREFETCH_STREAM };
+
+// Updates the mb x nb block of C at (i0, j0) over kb k-steps, interleaving AVX_OPS vector
+// and SCALAR_OPS scalar accumulators inside the kk loop. With BS > 0 the block is known to be
+// full (mb == nb == kb == bs == BS), so every trip count is a compile-time constant.
+// HINTS adds the prefetches and, when stream is set (final k-panel), streaming C stores: the
+// 9-column chunks of the default tuning put most vectors off a line boundary, so each row
+// segment is staged in an aligned stack buffer and then written with stream_row, which
+// streams every full line of it (segments wider than STREAM_STAGE_MAX stream only the
+// vectors that happen to be line aligned).
+template <int AVX_OPS, int SCALAR_OPS, int BS, int HINTS = HINTS_NONE>
+static inline void interleaved_block(const double *packA, const double *packB, double *C, int ldc,
+                                     int i0, int j0, int mb_rt, int nb_rt, int kb_rt, int bs_rt,
+                                     int N = 0, bool stream = false) {
+    constexpr int TOTAL_STEP_SIZE = (AVX_OPS * AVX_STEP_SIZE) + (SCALAR_OPS * SCALAR_STEP_SIZE);
+    static_assert(AVX_OPS > 0 && SCALAR_OPS > 0, "interleaved needs both AVX and scalar ops");
+    const int bs = BS > 0 ? BS : bs_rt;
+    const int mb = BS > 0 ? BS : mb_rt;
+    const int nb = BS > 0 ? BS : nb_rt;
+    const int kb = BS > 0 ? BS : kb_rt;
+    constexpr bool STREAMING = HINTS == HINTS_PREFETCH_STREAM;
+    alignas(64) double stage[STREAMING ? STREAM_STAGE_MAX : 1];
+    const bool staged = STREAMING && stream && nb <= STREAM_STAGE_MAX;
+    for (int ii = 0; ii < mb; ++ii) {
         int i = i0 + ii;
         int j_off = 0;
+        // Row segment the results go to: C itself, or the stage flushed by stream_row below
+        double *out = staged ? stage : &C[i * ldc + j0];
         
         // --- Main Loop ---
         // Process full interleaved chunks that fit within the block size.
-        for (; j_off + TOTAL_STEP_SIZE <= bs; j_off += TOTAL_STEP_SIZE) {
-            __m512d cvecs[INTERLEAVED_AVX_OPS];
-            double scalar_sums[INTERLEAVED_SCALAR_OPS];
-            int scalar_start_offset = INTERLEAVED_AVX_OPS * AVX_STEP_SIZE;
+        for (; j_off + TOTAL_STEP_SIZE <= nb; j_off += TOTAL_STEP_SIZE) {
+            __m512d cvecs[AVX_OPS];
+            double scalar_sums[SCALAR_OPS];
+            int scalar_start_offset = AVX_OPS * AVX_STEP_SIZE;
 
+            if (HINTS != HINTS_NONE) prefetch_next_c_tile(&C[i * ldc], j0, j_off, bs, N);
             // Load initial values from C
-            for(int k=0; k<INTERLEAVED_AVX_OPS; ++k) {
-                cvecs[k] = _mm512_loadu_pd(&C[i * N + j0 + j_off + k * AVX_STEP_SIZE]);
+            for(int k=0; k<AVX_OPS; ++k) {
+                cvecs[k] = _mm512_loadu_pd(&C[i * ldc + j0 + j_off + k * AVX_STEP_SIZE]);
             }
-            for(int k=0; k<INTERLEAVED_SCALAR_OPS; ++k) {
-                scalar_sums[k] = C[i * N + j0 + j_off + scalar_start_offset + k];
+            for(int k=0; k<SCALAR_OPS; ++k) {
+                scalar_sums[k] = C[i * ldc + j0 + j_off + scalar_start_offset + k];
             }
 
             // Interleaved accumulation loop over k
-            for (int kk = 0; kk < bs; ++kk) {
+            for (int kk = 0; kk < kb; ++kk) {
                 __m512d avec = _mm512_set1_pd(packA[ii * bs + kk]);
                 double aval = packA[ii * bs + kk];
                 
                 // AVX part
-                for(int k=0; k<INTERLEAVED_AVX_OPS; ++k) {
+                for(int k=0; k<AVX_OPS; ++k) {
+                    if (HINTS != HINTS_NONE) prefetch_packB_row(&packB[kk * bs + j_off + k * AVX_STEP_SIZE], bs);
                     __m512d bvec = _mm512_loadu_pd(&packB[kk * bs + j_off + k * AVX_STEP_SIZE]);
                     cvecs[k] = _mm512_fmadd_pd(avec, bvec, cvecs[k]);
                 }
                 // Scalar part
-                for(int k=0; k<INTERLEAVED_SCALAR_OPS; ++k) {
+                for(int k=0; k<SCALAR_OPS; ++k) {
                     scalar_sums[k] += aval * packB[kk * bs + j_off + scalar_start_offset + k];
                 }
             }
 
             // Store results back to C
-            for(int k=0; k<INTERLEAVED_AVX_OPS; ++k) {
-                _mm512_storeu_pd(&C[i * N + j0 + j_off + k * AVX_STEP_SIZE], cvecs[k]);
+            for(int k=0; k<AVX_OPS; ++k) {
+                if (STREAMING && !staged) {
+                    store_c_full(&out[j_off + k * AVX_STEP_SIZE], cvecs[k], stream);
+                } else {
+                    _mm512_storeu_pd(&out[j_off + k * AVX_STEP_SIZE], cvecs[k]);
+                }
             }
-            for(int k=0; k<INTERLEAVED_SCALAR_OPS; ++k) {
-                C[i * N + j0 + j_off + scalar_start_offset + k] = scalar_sums[k];
+            for(int k=0; k<SCALAR_OPS; ++k) {
+                out[j_off + scalar_start_offset + k] = scalar_sums[k];
             }
         }
 
         // --- Cleanup Loop ---
-        // Process the remainder with a safe scalar loop.
-        for (; j_off < bs; ++j_off) {
-            double sum = C[i * N + j0 + j_off];
-            for (int kk = 0; kk < bs; ++kk) {
-                sum += packA[ii * bs + kk] * packB[kk * bs + j_off];
+        // Process the remaining columns in 8-wide strips, masking the lanes past nb.
+        for (; j_off < nb; j_off += AVX_STEP_SIZE) {
+            __mmask8 mask = (__mmask8)((1u << std::min(AVX_STEP_SIZE, nb - j_off)) - 1);
+            __m512d cvec = _mm512_maskz_loadu_pd(mask, &C[i * ldc + j0 + j_off]);
+            for (int kk = 0; kk < kb; ++kk) {
+                __m512d avec = _mm512_set1_pd(packA[ii * bs + kk]);
+                __m512d bvec = _mm512_maskz_loadu_pd(mask, &packB[kk * bs + j_off]);
+                cvec = _mm512_fmadd_pd(avec, bvec, cvec);
             }
-            C[i * N + j0 + j_off] = sum;
+            _mm512_mask_storeu_pd(&out[j_off], mask, cvec);
         }
+        if (staged) stream_row(&C[i * ldc + j0], stage, nb);
+    }
+}
+
+template <int AVX_OPS, int SCALAR_OPS, int HINTS = HINTS_NONE>
+static inline void kernel_interleaved_t(const double *packA, const double *packB, double *C,
+                                        int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    const bool full = mb == bs && nb == bs && kb == bs;
+    const bool stream = HINTS == HINTS_PREFETCH_STREAM && k0 + bs >= K;
+    with_block_size<INTERLEAVED_GRID_BLOCK_SIZES>(full ? bs : 0, [&](auto block) {
+        interleaved_block<AVX_OPS, SCALAR_OPS, decltype(block)::value, HINTS>(packA, packB, C, ldc, i0, j0,
+                                                                             mb, nb, kb, bs, N, stream);
+    });
+    if (stream) _mm_sfence();
+}
+
+#define DEFINE_KERNEL_INTERLEAVED(a, s)                                                                          \
+    extern "C" void kernel_interleaved_##a##_##s(const double *packA, const double *packB, double *C,            \
+                                                 int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) { \
+        kernel_interleaved_t<a, s>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);                               \
     }
+INTERLEAVED_TUNING_GRID(DEFINE_KERNEL_INTERLEAVED)
+
+// Default tuning <1,1> with the memory hints, measured against plain "interleaved"
+extern "C" void kernel_interleaved_pf(const double *packA, const double *packB, double *C,
+                                      int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    kernel_interleaved_t<1, 1, HINTS_PREFETCH>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);
+}
+
+extern "C" void kernel_interleaved_nt(const double *packA, const double *packB, double *C,
+                                      int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    kernel_interleaved_t<1, 1, HINTS_PREFETCH_STREAM>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);
 }
@@ -0,0 +1,106 @@
+#include <immintrin.h>
+#include <algorithm>
+#include <cstddef>
+
+#include "kernel_grid.h"
+
+// AVX2/FMA3 counterpart of kernel_interleaved.cpp for hosts without AVX-512. The grid keeps
+// counting vector ops, so with 256-bit vectors one AVX op covers 4 columns.
+constexpr int AVX_STEP_SIZE = 4; // doubles per ymm vector
+constexpr int SCALAR_STEP_SIZE = 1;
+
+// Updates the mb x nb block of C at (i0, j0) over kb k-steps, interleaving AVX_OPS vector
+// and SCALAR_OPS scalar accumulators inside the kk loop. With BS > 0 the block is known to be
+// full (mb == nb == kb == bs == BS), so every trip count is a compile-time constant.
+// Lane mask selecting the first n (1..4) doubles of a ymm vector
+static inline __m256i lane_mask(int n) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+template <int AVX_OPS, int SCALAR_OPS, int BS>
+static inline void interleaved_block(const double *packA, const double *packB, double *C, int ldc,
+                                     int i0, int j0, int mb_rt, int nb_rt, int kb_rt, int bs_rt) {
+    constexpr int TOTAL_STEP_SIZE = (AVX_OPS * AVX_STEP_SIZE) + (SCALAR_OPS * SCALAR_STEP_SIZE);
+    static_assert(AVX_OPS > 0 && SCALAR_OPS > 0, "interleaved needs both AVX and scalar ops");
+    const int bs = BS > 0 ? BS : bs_rt;
+    const int mb = BS > 0 ? BS : mb_rt;
+    const int nb = BS > 0 ? BS : nb_rt;
+    const int kb = BS > 0 ? BS : kb_rt;
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        int j_off = 0;
+        
+        // --- Main Loop ---
+        // Process full interleaved chunks that fit within the block size.
+        for (; j_off + TOTAL_STEP_SIZE <= nb; j_off += TOTAL_STEP_SIZE) {
+            __m256d cvecs[AVX_OPS];
+            double scalar_sums[SCALAR_OPS];
+            int scalar_start_offset = AVX_OPS * AVX_STEP_SIZE;
+
+            // Load initial values from C
+            for(int k=0; k<AVX_OPS; ++k) {
+                cvecs[k] = _mm256_loadu_pd(&C[i * ldc + j0 + j_off + k * AVX_STEP_SIZE]);
+            }
+            for(int k=0; k<SCALAR_OPS; ++k) {
+                scalar_sums[k] = C[i * ldc + j0 + j_off + scalar_start_offset + k];
+            }
+
+            // Interleaved accumulation loop over k
+            for (int kk = 0; kk < kb; ++kk) {
+                __m256d avec = _mm256_set1_pd(packA[ii * bs + kk]);
+                double aval = packA[ii * bs + kk];
+                
+                // AVX part
+                for(int k=0; k<AVX_OPS; ++k) {
+                    __m256d bvec = _mm256_loadu_pd(&packB[kk * bs + j_off + k * AVX_STEP_SIZE]);
+                    cvecs[k] = _mm256_fmadd_pd(avec, bvec, cvecs[k]);
+                }
+                // Scalar part
+                for(int k=0; k<SCALAR_OPS; ++k) {
+                    scalar_sums[k] += aval * packB[kk * bs + j_off + scalar_start_offset + k];
+                }
+            }
+
+            // Store results back to C
+            for(int k=0; k<AVX_OPS; ++k) {
+                _mm256_storeu_pd(&C[i * ldc + j0 + j_off + k * AVX_STEP_SIZE], cvecs[k]);
+            }
+            for(int k=0; k<SCALAR_OPS; ++k) {
+                C[i * ldc + j0 + j_off + scalar_start_offset + k] = scalar_sums[k];
+            }
+        }
+
+        // --- Cleanup Loop ---
+        // Process the remaining columns in 4-wide strips, masking the lanes past nb.
+        for (; j_off < nb; j_off += AVX_STEP_SIZE) {
+            __m256i mask = lane_mask(std::min(AVX_STEP_SIZE, nb - j_off));
+            __m256d cvec = _mm256_maskload_pd(&C[i * ldc + j0 + j_off], mask);
+            for (int kk = 0; kk < kb; ++kk) {
+                __m256d avec = _mm256_set1_pd(packA[ii * bs + kk]);
+                __m256d bvec = _mm256_maskload_pd(&packB[kk * bs + j_off], mask);
+                cvec = _mm256_fmadd_pd(avec, bvec, cvec);
+            }
+            _mm256_maskstore_pd(&C[i * ldc + j0 + j_off], mask, cvec);
+        }
+    }
+}
+
+template <int AVX_OPS, int SCALAR_OPS>
+static inline void kernel_interleaved_t(const double *packA, const double *packB, double *C,
+                                        int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    const bool full = mb == bs && nb == bs && kb == bs;
+    with_block_size<INTERLEAVED_GRID_BLOCK_SIZES>(full ? bs : 0, [&](auto block) {
+        interleaved_block<AVX_OPS, SCALAR_OPS, decltype(block)::value>(packA, packB, C, ldc, i0, j0, mb, nb, kb, bs);
+    });
+}
+
+#define DEFINE_KERNEL_INTERLEAVED_AVX2(a, s)                                                                          \
+    extern "C" void kernel_interleaved_avx2_##a##_##s(const double *packA, const double *packB, double *C,            \
+                                                      int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) { \
+        kernel_interleaved_t<a, s>(packA, packB, C, M, N, K, ldc, i0, j0, k0, bs);                                    \
+    }
+INTERLEAVED_TUNING_GRID(DEFINE_KERNEL_INTERLEAVED_AVX2)
@@ -0,0 +1,235 @@
+#include "kernels_whole.h"
+#include "morton.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+static int ceil_pow2(int v) {
+    int p = 1;
+    while (p < v) p *= 2;
+    return p;
+}
+
+static int log2_exact(int p) {
+    int b = 0;
+    while ((1 << b) < p) ++b;
+    return b;
+}
+
+MortonGrid morton_grid(const MortonConfig &cfg, const GemmDims &d) {
+    const int bs = cfg.leaf_bs;
+    MortonGrid g;
+    g.mt = (d.M + bs - 1) / bs;
+    g.nt = (d.N + bs - 1) / bs;
+    g.kt = (d.K + bs - 1) / bs;
+    g.mt_pad = ceil_pow2(g.mt);
+    g.nt_pad = ceil_pow2(g.nt);
+    g.kt_pad = ceil_pow2(g.kt);
+    return g;
+}
+
+// Tile slots of the A, B and C copies (each tile is bs * bs doubles); only real tiles are
+// stored, so the powers-of-two padding costs no memory
+static size_t tiles_a(const MortonGrid &g) { return size_t(g.mt) * g.kt; }
+static size_t tiles_b(const MortonGrid &g) { return size_t(g.kt) * g.nt; }
+static size_t tiles_c(const MortonGrid &g) { return size_t(g.mt) * g.nt; }
+
+double morton_layout_bytes(const MortonConfig &cfg, const GemmDims &d) {
+    const MortonGrid g = morton_grid(cfg, d);
+    const double tile = double(cfg.leaf_bs) * cfg.leaf_bs * sizeof(double);
+    return double(tiles_a(g) + tiles_b(g) + tiles_c(g)) * tile;
+}
+
+namespace {
+
+// Position of tile (r, c) in a rows_pad x cols_pad grid: the row and column bits are
+// interleaved (row bit above column bit) up to the smaller grid side, and the remaining
+// high bits of the longer side select one of the square sub-grids stored back to back.
+struct ZOrder {
+    int row_bits, col_bits;
+
+    ZOrder(int rows_pad, int cols_pad) : row_bits(log2_exact(rows_pad)), col_bits(log2_exact(cols_pad)) {}
+
+    size_t operator()(int r, int c) const {
+        const int common = std::min(row_bits, col_bits);
+        size_t z = 0;
+        for (int b = 0; b < common; ++b) {
+            z |= size_t((r >> b) & 1) << (2 * b + 1);
+            z |= size_t((c >> b) & 1) << (2 * b);
+        }
+        const size_t rest = row_bits > col_bits ? size_t(r >> common) : size_t(c >> common);
+        return z | (rest << (2 * common));
+    }
+};
+
+// Slot of each real tile of a rows x cols grid: its rank in the Z order of the padded
+// grid. Padded tiles get no slot, and the real ones keep their relative Z order, so every
+// recursion level still covers a contiguous run of slots.
+struct DenseZ {
+    int rows = 0, cols = 0;
+    std::vector<size_t> slot; // indexed r * cols + c
+    std::vector<std::pair<size_t, size_t>> order;
+
+    void build(int r_tiles, int c_tiles, int rows_pad, int cols_pad) {
+        if (r_tiles == rows && c_tiles == cols) return;
+        const ZOrder z(rows_pad, cols_pad);
+        order.clear();
+        for (int r = 0; r < r_tiles; ++r) {
+            for (int c = 0; c < c_tiles; ++c) order.emplace_back(z(r, c), size_t(r) * c_tiles + c);
+        }
+        std::sort(order.begin(), order.end());
+        slot.resize(order.size());
+        for (size_t rank = 0; rank < order.size(); ++rank) slot[order[rank].second] = rank;
+        rows = r_tiles;
+        cols = c_tiles;
+    }
+
+    size_t operator()(int r, int c) const { return slot[size_t(r) * cols + c]; }
+};
+
+// Z-ordered tile copies of A, B and C plus their slot tables, one grow-only set per thread
+// (batched whole runs call the kernel concurrently)
+struct Workspace {
+    double *p = nullptr;
+    size_t capacity = 0;
+    DenseZ za, zb, zc;
+
+    ~Workspace() { free(p); }
+
+    bool grow(size_t elems) {
+        if (elems <= capacity) return true;
+        void *v = nullptr;
+        if (posix_memalign(&v, 64, sizeof(double) * elems) != 0) return false;
+        memset(v, 0, sizeof(double) * elems); // prefault
+        free(p);
+        p = static_cast<double*>(v);
+        capacity = elems;
+        return true;
+    }
+
+    // Buffer and slot tables for this grid; the tables are rebuilt only when it changes
+    bool prepare(const MortonGrid &g, size_t elems) {
+        if (!grow(elems)) return false;
+        za.build(g.mt, g.kt, g.mt_pad, g.kt_pad);
+        zb.build(g.kt, g.nt, g.kt_pad, g.nt_pad);
+        zc.build(g.mt, g.nt, g.mt_pad, g.nt_pad);
+        return true;
+    }
+};
+
+} // namespace
+
+static thread_local Workspace workspace;
+
+static size_t workspace_elems(const MortonConfig &cfg, const GemmDims &d) {
+    const MortonGrid g = morton_grid(cfg, d);
+    return (tiles_a(g) + tiles_b(g) + tiles_c(g)) * size_t(cfg.leaf_bs) * cfg.leaf_bs;
+}
+
+bool morton_reserve(const MortonConfig &cfg, const GemmDims &d, int num_threads) {
+    const MortonGrid g = morton_grid(cfg, d);
+    const size_t elems = workspace_elems(cfg, d);
+    bool ok = true;
+    #pragma omp parallel num_threads(num_threads) reduction(&& : ok)
+    ok = workspace.prepare(g, elems);
+    return ok;
+}
+
+// Copies the valid part of every real tile of a row-major matrix into its Z-order slot;
+// tiles keep a leading dimension of bs (the packA / packB layout of the block kernels)
+static void to_morton(const double *src, int ld, int rows, int cols, double *dst, const DenseZ &z, int bs) {
+    for (int tr = 0; tr * bs < rows; ++tr) {
+        for (int tc = 0; tc * bs < cols; ++tc) {
+            double *tile = dst + z(tr, tc) * bs * bs;
+            const int rb = std::min(bs, rows - tr * bs), cb = std::min(bs, cols - tc * bs);
+            for (int i = 0; i < rb; ++i) {
+                memcpy(tile + size_t(i) * bs, src + size_t(tr * bs + i) * ld + tc * bs, sizeof(double) * cb);
+            }
+        }
+    }
+}
+
+static void from_morton(const double *src, const DenseZ &z, int bs, double *dst, int ld, int rows, int cols) {
+    for (int tr = 0; tr * bs < rows; ++tr) {
+        for (int tc = 0; tc * bs < cols; ++tc) {
+            const double *tile = src + z(tr, tc) * bs * bs;
+            const int rb = std::min(bs, rows - tr * bs), cb = std::min(bs, cols - tc * bs);
+            for (int i = 0; i < rb; ++i) {
+                memcpy(dst + size_t(tr * bs + i) * ld + tc * bs, tile + size_t(i) * bs, sizeof(double) * cb);
+            }
+        }
+    }
+}
+
+namespace {
+
+// Shared state of one product
+struct Product {
+    matmul_func_t leaf;
+    const double *A, *B;
+    double *C;
+    const DenseZ &za, &zb, &zc;
+    int M, N, K, bs;
+    int mt, nt, kt; // real tile counts; padded tiles are skipped
+};
+
+} // namespace
+
+// C[i.., j..] += A[i.., k..] * B[k.., j..] over m x n x k tiles (all powers of two)
+static void recurse(const Product &p, int i, int j, int k, int m, int n, int kk) {
+    if (i >= p.mt || j >= p.nt || k >= p.kt) return;
+    if (m == 1 && n == 1 && kk == 1) {
+        const size_t tile = size_t(p.bs) * p.bs;
+        // i0 = j0 = k0 = 0 inside the tile, so M / N / K carry the valid extents
+        p.leaf(p.A + p.za(i, k) * tile, p.B + p.zb(k, j) * tile, p.C + p.zc(i, j) * tile,
+               std::min(p.bs, p.M - i * p.bs), std::min(p.bs, p.N - j * p.bs),
+               std::min(p.bs, p.K - k * p.bs), p.bs, 0, 0, 0, p.bs);
+        return;
+    }
+    // Halve the largest extent; m before n keeps C quadrants in Z order
+    if (m >= n && m >= kk) {
+        recurse(p, i, j, k, m / 2, n, kk);
+        recurse(p, i + m / 2, j, k, m / 2, n, kk);
+    } else if (n >= kk) {
+        recurse(p, i, j, k, m, n / 2, kk);
+        recurse(p, i, j + n / 2, k, m, n / 2, kk);
+    } else {
+        recurse(p, i, j, k, m, n, kk / 2);
+        recurse(p, i, j, k + kk / 2, m, n, kk / 2);
+    }
+}
+
+// C = A * B under cfg through the Z-ordered copies. The layout conversion is part of every
+// call, like packing is for the block runners.
+void morton_gemm(const MortonConfig &cfg, const double *A, const double *B, double *C,
+                 int M, int N, int K, int lda, int ldb, int ldc) {
+    GemmDims d;
+    d.M = M; d.N = N; d.K = K;
+    d.lda = lda; d.ldb = ldb; d.ldc = ldc;
+    const MortonGrid g = morton_grid(cfg, d);
+    if (!cfg.leaf || !workspace.prepare(g, workspace_elems(cfg, d))) {
+        kernel_blas_whole(A, B, C, M, N, K, lda, ldb, ldc);
+        return;
+    }
+    const int bs = cfg.leaf_bs;
+    const size_t tile = size_t(bs) * bs;
+    double *Az = workspace.p, *Bz = Az + tiles_a(g) * tile, *Cz = Bz + tiles_b(g) * tile;
+    Product p{cfg.leaf, Az, Bz, Cz, workspace.za, workspace.zb, workspace.zc, M, N, K, bs, g.mt, g.nt, g.kt};
+
+    to_morton(A, lda, M, K, Az, p.za, bs);
+    to_morton(B, ldb, K, N, Bz, p.zb, bs);
+    // The leaf kernels accumulate; Cz holds only the real tiles, and only their valid parts
+    // are ever read back
+    memset(Cz, 0, sizeof(double) * tiles_c(g) * tile);
+    recurse(p, 0, 0, 0, g.mt_pad, g.nt_pad, g.kt_pad);
+    from_morton(Cz, p.zc, bs, C, ldc, M, N);
+}
+
+// Whole-matrix entry point with the default configuration, which has no leaf (and so
+// falls back to kernel_blas_whole)
+extern "C" void kernel_morton_whole(const double *A, const double *B, double *C,
+                                    int M, int N, int K, int lda, int ldb, int ldc) {
+    morton_gemm(MortonConfig(), A, B, C, M, N, K, lda, ldb, ldc);
+}
@@ -1,22 +1,27 @@
+#include <algorithm>
 #include <cstddef>
 
 extern "C" void kernel_scalar(const double *packA, const double *packB, double *C,
-                                    int N, int i0, int j0, int k0, int bs)
+                                    int M, int N, int K, int ldc, int i0, int j0, int k0, int bs)
 {
     // packA layout: packA[ii*bs + kk]
     // packB layout: packB[kk*bs + jj]
-    for (int ii = 0; ii < bs; ++ii) {
+    // Edge blocks are partial: only mb x nb of C and kb of the k-block are valid.
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ++ii) {
         int i = i0 + ii;
-        for (int jj = 0; jj < bs; ++jj) {
+        for (int jj = 0; jj < nb; ++jj) {
             int j = j0 + jj;
             // single accumulator -> dependent chain
-            double sum = C[i * N + j];
-            for (int kk = 0; kk < bs; ++kk) {
+            double sum = C[i * ldc + j];
+            for (int kk = 0; kk < kb; ++kk) {
                 double a = packA[ii * bs + kk];
                 double b = packB[kk * bs + jj];
                 sum = sum + a * b;
             }
-            C[i * N + j] = sum;
+            C[i * ldc + j] = sum;
         }
     }
 }
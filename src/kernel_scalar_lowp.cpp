@@ -0,0 +1,48 @@
+#include "dtype.h"
+#include <algorithm>
+#include <cstddef>
+
+// Portable fallbacks for the reduced-precision block kernels (--dtype f32 / bf16)
+
+extern "C" void kernel_scalar_f32(const float *packA, const float *packB, float *C,
+                                  int M, int N, int K, int ldc, int i0, int j0, int k0, int bs)
+{
+    // Same layouts and edge semantics as kernel_scalar, in single precision
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        for (int jj = 0; jj < nb; ++jj) {
+            int j = j0 + jj;
+            float sum = C[i * ldc + j];
+            for (int kk = 0; kk < kb; ++kk) {
+                sum = sum + packA[ii * bs + kk] * packB[kk * bs + jj];
+            }
+            C[i * ldc + j] = sum;
+        }
+    }
+}
+
+extern "C" void kernel_scalar_bf16(const bf16_t *packA, const bf16_t *packB, float *C,
+                                   int M, int N, int K, int ldc, int i0, int j0, int k0, int bs)
+{
+    // packB holds k pairs: packB[(kk/2)*2*bs + 2*jj + (kk&1)]; products are exact in
+    // float, the accumulation is rounded to float as vdpbf16ps does
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ++ii) {
+        int i = i0 + ii;
+        for (int jj = 0; jj < nb; ++jj) {
+            int j = j0 + jj;
+            float sum = C[i * ldc + j];
+            for (int kk = 0; kk < kb; ++kk) {
+                float a = bf16_to_float(packA[ii * bs + kk]);
+                float b = bf16_to_float(packB[(kk / 2) * 2 * bs + 2 * jj + (kk & 1)]);
+                sum = sum + a * b;
+            }
+            C[i * ldc + j] = sum;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#include "kernels_packed.h"
+#include <algorithm>
+#include <cstddef>
+
+// Portable kernel over the panel-major sliver layout (see kernels_packed.h). It is the
+// scalar_packed mode and the fallback for avx_packed on hosts without AVX-512.
+extern "C" void kernel_scalar_packed(const double *packA, const double *packB, double *C,
+                                     int M, int N, int K, int ldc, int i0, int j0, int k0, int bs) {
+    const int mb = std::min(bs, M - i0);
+    const int nb = std::min(bs, N - j0);
+    const int kb = std::min(bs, K - k0);
+    for (int ii = 0; ii < mb; ii += PACK_MR) {
+        int h = std::min(PACK_MR, mb - ii);
+        const double *asliver = &packA[ii * bs];
+        for (int jj = 0; jj < nb; jj += PACK_NR) {
+            int w = std::min(PACK_NR, nb - jj);
+            const double *bsliver = &packB[jj * bs];
+            for (int r = 0; r < h; ++r) {
+                double *crow = &C[(i0 + ii + r) * ldc + j0 + jj];
+                for (int c = 0; c < w; ++c) {
+                    double sum = crow[c];
+                    for (int kk = 0; kk < kb; ++kk) {
+                        sum += asliver[kk * h + r] * bsliver[kk * w + c];
+                    }
+                    crow[c] = sum;
+                }
+            }
+        }
+    }
+}
@@ -1,14 +1,15 @@
 #include "kernels_whole.h"
 
-// A simple O(N^3) matrix multiplication kernel operating on the whole matrix.
-extern "C" void kernel_scalar_whole(const double *A, const double *B, double *C, int N) {
-    for (int i = 0; i < N; ++i) {
+// A simple O(M*N*K) matrix multiplication kernel operating on the whole matrix.
+extern "C" void kernel_scalar_whole(const double *A, const double *B, double *C,
+                                    int M, int N, int K, int lda, int ldb, int ldc) {
+    for (int i = 0; i < M; ++i) {
         for (int j = 0; j < N; ++j) {
             double sum = 0.0;
-            for (int k = 0; k < N; ++k) {
-                sum += A[i * N + k] * B[k * N + j];
+            for (int k = 0; k < K; ++k) {
+                sum += A[i * lda + k] * B[k * ldb + j];
             }
-            C[i * N + j] = sum;
+            C[i * ldc + j] = sum;
         }
     }
 }
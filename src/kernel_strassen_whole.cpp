@@ -0,0 +1,190 @@
+#include "kernels_whole.h"
+#include "runner.h"
+#include "strassen.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Temporaries X (m/2 x k/2), Y (k/2 x n/2) and Z (m/2 x n/2) for every level, carved out
+// of one grow-only buffer per thread (batched whole runs call the kernel concurrently)
+struct Workspace {
+    double *p = nullptr;
+    size_t capacity = 0;
+
+    ~Workspace() { free(p); }
+
+    bool grow(size_t elems) {
+        if (elems <= capacity) return true;
+        void *v = nullptr;
+        if (posix_memalign(&v, 64, sizeof(double) * elems) != 0) return false;
+        memset(v, 0, sizeof(double) * elems); // prefault
+        free(p);
+        p = static_cast<double*>(v);
+        capacity = elems;
+        return true;
+    }
+};
+
+} // namespace
+
+static thread_local Workspace workspace;
+
+static bool recurse_at(const StrassenConfig &cfg, int m, int n, int k, int level) {
+    return level < cfg.max_levels && std::min(m, std::min(n, k)) > cfg.cutoff
+           && std::min(m, std::min(n, k)) >= 2;
+}
+
+static size_t workspace_elems(const StrassenConfig &cfg, int m, int n, int k, int level) {
+    if (!recurse_at(cfg, m, n, k, level)) return 0;
+    const size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+    return m2 * k2 + k2 * n2 + m2 * n2 + workspace_elems(cfg, int(m2), int(n2), int(k2), level + 1);
+}
+
+static double flops_at(const StrassenConfig &cfg, int m, int n, int k, int level) {
+    if (!recurse_at(cfg, m, n, k, level)) return 2.0 * m * n * k;
+    const int m2 = m / 2, n2 = n / 2, k2 = k / 2;
+    const int me = 2 * m2, ne = 2 * n2, ke = 2 * k2;
+    double f = 7.0 * flops_at(cfg, m2, n2, k2, level + 1);
+    f += 4.0 * m2 * k2 + 4.0 * k2 * n2 + 7.0 * m2 * n2;  // S, T and U additions
+    if (k != ke) f += 2.0 * me * ne;                     // rank-1 update for the odd k
+    if (n != ne) f += 2.0 * m * k;                       // last column
+    if (m != me) f += 2.0 * ne * k;                      // last row
+    return f;
+}
+
+int strassen_levels(const StrassenConfig &cfg, const GemmDims &d) {
+    int level = 0;
+    for (int m = d.M, n = d.N, k = d.K; recurse_at(cfg, m, n, k, level); m /= 2, n /= 2, k /= 2) ++level;
+    return level;
+}
+
+double strassen_flops(const StrassenConfig &cfg, const GemmDims &d) {
+    return flops_at(cfg, d.M, d.N, d.K, 0);
+}
+
+bool strassen_reserve(const StrassenConfig &cfg, const GemmDims &d, int num_threads) {
+    const size_t elems = workspace_elems(cfg, d.M, d.N, d.K, 0);
+    bool ok = true;
+    #pragma omp parallel num_threads(num_threads) reduction(&& : ok)
+    ok = workspace.grow(elems);
+    return ok;
+}
+
+// Z = X + sign * Y for rows x cols blocks
+static void add(const double *X, int ldx, const double *Y, int ldy, double *Z, int ldz,
+                int rows, int cols, double sign) {
+    for (int i = 0; i < rows; ++i) {
+        const double *x = X + size_t(i) * ldx;
+        const double *y = Y + size_t(i) * ldy;
+        double *z = Z + size_t(i) * ldz;
+        for (int j = 0; j < cols; ++j) z[j] = x[j] + sign * y[j];
+    }
+}
+
+// C = A * B with the configured leaf
+static void leaf_product(const StrassenConfig &cfg, const double *A, const double *B, double *C, int m, int n, int k,
+                         int lda, int ldb, int ldc) {
+    if (!cfg.leaf) {
+        kernel_blas_whole(A, B, C, m, n, k, lda, ldb, ldc);
+        return;
+    }
+    // Block runners accumulate into C
+    for (int i = 0; i < m; ++i) memset(C + size_t(i) * ldc, 0, sizeof(double) * n);
+    GemmDims d;
+    d.M = m; d.N = n; d.K = k;
+    d.lda = lda; d.ldb = ldb; d.ldc = ldc;
+    run_benchmark(A, B, C, d, cfg.leaf_bs, cfg.leaf);
+}
+
+static void product(const StrassenConfig &cfg, const double *A, const double *B, double *C, int m, int n, int k,
+                    int lda, int ldb, int ldc, double *work, int level);
+
+// One Winograd level on the even-sized leading part, using the three-temporary schedule
+// of Douglas et al. (DGEFMM): the partial products are parked in the C quadrants.
+static void winograd(const StrassenConfig &cfg, const double *A, const double *B, double *C, int m2, int n2, int k2,
+                     int lda, int ldb, int ldc, double *work, int level) {
+    const double *A11 = A, *A12 = A + k2, *A21 = A + size_t(m2) * lda, *A22 = A21 + k2;
+    const double *B11 = B, *B12 = B + n2, *B21 = B + size_t(k2) * ldb, *B22 = B21 + n2;
+    double *C11 = C, *C12 = C + n2, *C21 = C + size_t(m2) * ldc, *C22 = C21 + n2;
+    double *X = work, *Y = X + size_t(m2) * k2, *Z = Y + size_t(k2) * n2;
+    double *next = Z + size_t(m2) * n2;
+    const int ldx = k2, ldy = n2, ldz = n2;
+
+    add(A11, lda, A21, lda, X, ldx, m2, k2, -1.0);               // S3 = A11 - A21
+    add(B22, ldb, B12, ldb, Y, ldy, k2, n2, -1.0);               // T3 = B22 - B12
+    product(cfg, X, Y, C21, m2, n2, k2, ldx, ldy, ldc, next, level);  // C21 = P7 = S3 T3
+    add(A21, lda, A22, lda, X, ldx, m2, k2, 1.0);                // S1 = A21 + A22
+    add(B12, ldb, B11, ldb, Y, ldy, k2, n2, -1.0);               // T1 = B12 - B11
+    product(cfg, X, Y, C22, m2, n2, k2, ldx, ldy, ldc, next, level);  // C22 = P5 = S1 T1
+    add(X, ldx, A11, lda, X, ldx, m2, k2, -1.0);                 // S2 = S1 - A11
+    add(B22, ldb, Y, ldy, Y, ldy, k2, n2, -1.0);                 // T2 = B22 - T1
+    product(cfg, X, Y, C12, m2, n2, k2, ldx, ldy, ldc, next, level);  // C12 = P6 = S2 T2
+    add(A12, lda, X, ldx, X, ldx, m2, k2, -1.0);                 // S4 = A12 - S2
+    product(cfg, X, B22, C11, m2, n2, k2, ldx, ldb, ldc, next, level); // C11 = P3 = S4 B22
+    product(cfg, A11, B11, Z, m2, n2, k2, lda, ldb, ldz, next, level); // Z = P1
+    add(Z, ldz, C12, ldc, C12, ldc, m2, n2, 1.0);                // C12 = U2 = P1 + P6
+    add(C12, ldc, C21, ldc, C21, ldc, m2, n2, 1.0);              // C21 = U3 = U2 + P7
+    add(C12, ldc, C22, ldc, C12, ldc, m2, n2, 1.0);              // C12 = U4 = U2 + P5
+    add(C21, ldc, C22, ldc, C22, ldc, m2, n2, 1.0);              // C22 = U7 = U3 + P5 (final)
+    add(C12, ldc, C11, ldc, C12, ldc, m2, n2, 1.0);              // C12 = U5 = U4 + P3 (final)
+    add(Y, ldy, B21, ldb, Y, ldy, k2, n2, -1.0);                 // T4 = T2 - B21
+    product(cfg, A22, Y, C11, m2, n2, k2, lda, ldy, ldc, next, level); // C11 = P4 = A22 T4
+    add(C21, ldc, C11, ldc, C21, ldc, m2, n2, -1.0);             // C21 = U6 = U3 - P4 (final)
+    product(cfg, A12, B21, C11, m2, n2, k2, lda, ldb, ldc, next, level); // C11 = P2
+    add(Z, ldz, C11, ldc, C11, ldc, m2, n2, 1.0);                // C11 = U1 = P1 + P2 (final)
+}
+
+static void product(const StrassenConfig &cfg, const double *A, const double *B, double *C, int m, int n, int k,
+                    int lda, int ldb, int ldc, double *work, int level) {
+    if (!recurse_at(cfg, m, n, k, level)) {
+        leaf_product(cfg, A, B, C, m, n, k, lda, ldb, ldc);
+        return;
+    }
+    const int m2 = m / 2, n2 = n / 2, k2 = k / 2;
+    const int me = 2 * m2, ne = 2 * n2, ke = 2 * k2;
+    winograd(cfg, A, B, C, m2, n2, k2, lda, ldb, ldc, work, level + 1);
+
+    // Dynamic peeling: the odd row / column / k slice left out of the even part
+    if (k != ke) {
+        for (int i = 0; i < me; ++i) {
+            const double a = A[size_t(i) * lda + ke];
+            const double *brow = B + size_t(ke) * ldb;
+            double *crow = C + size_t(i) * ldc;
+            for (int j = 0; j < ne; ++j) crow[j] += a * brow[j];
+        }
+    }
+    if (n != ne) {
+        for (int i = 0; i < m; ++i) {
+            double s = 0.0;
+            for (int kk = 0; kk < k; ++kk) s += A[size_t(i) * lda + kk] * B[size_t(kk) * ldb + ne];
+            C[size_t(i) * ldc + ne] = s;
+        }
+    }
+    if (m != me) {
+        double *crow = C + size_t(me) * ldc;
+        for (int j = 0; j < ne; ++j) crow[j] = 0.0;
+        for (int kk = 0; kk < k; ++kk) {
+            const double a = A[size_t(me) * lda + kk];
+            const double *brow = B + size_t(kk) * ldb;
+            for (int j = 0; j < ne; ++j) crow[j] += a * brow[j];
+        }
+    }
+}
+
+// C = A * B under cfg, temporaries from the calling thread's workspace
+void strassen_gemm(const StrassenConfig &cfg, const double *A, const double *B, double *C,
+                   int M, int N, int K, int lda, int ldb, int ldc) {
+    if (!workspace.grow(workspace_elems(cfg, M, N, K, 0))) {
+        kernel_blas_whole(A, B, C, M, N, K, lda, ldb, ldc);
+        return;
+    }
+    product(cfg, A, B, C, M, N, K, lda, ldb, ldc, workspace.p, 0);
+}
+
+// Whole-matrix entry point with the default configuration
+extern "C" void kernel_strassen_whole(const double *A, const double *B, double *C,
+                                      int M, int N, int K, int lda, int ldb, int ldc) {
+    strassen_gemm(StrassenConfig(), A, B, C, M, N, K, lda, ldb, ldc);
+}
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -6,34 +10,256 @@
 #include <string>
 #include <vector> // Required for argument parsing
 
+#include "matmul.h"
 #include "papito.h"
 #include "matrix_utils.h"
-#include "dispatch_kernels.h"
-#include "dispatch_kernels_whole.h"
-#include "runner.h"
-#include "runner_whole.h"
+#include "matrix_io.h"
+#include "cpu_features.h"
+#include "autotune.h"
+#include "bench_stats.h"
+#include "run_report.h"
+#include "roofline.h"
+#include "verify.h"
+#include "strassen.h"
+#include "morton.h"
+#include "affinity.h"
+#include "energy.h"
+#include "dtype.h"
 
-// Function to print the matrix to stdout
-void print_matrix(const double* M, int N) {
-    for (int i = 0; i < N * N; ++i) {
-        printf("%.10f\n", M[i]);
+// Function to print the rows x cols matrix (leading dimension ld) to stdout
+void print_matrix(const double* Mat, int rows, int cols, int ld) {
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            printf("%.10f\n", Mat[i * ld + j]);
+        }
     }
 }
 
+// Maps an operand file and checks that it holds batch rows x cols matrices
+static double* map_operand(const std::string &path, const char *name, int rows, int cols, int batch,
+                           matrix_io::MappedMatrix *m) {
+    std::string err;
+    if (!matrix_io::map_matrix(path, m, &err)) {
+        fprintf(stderr, "Error: %s\n", err.c_str());
+        return nullptr;
+    }
+    if (m->rows != rows || m->cols != cols || m->batch != batch) {
+        fprintf(stderr, "Error: %s holds %d matrices of %d x %d, but %s needs %d of %d x %d.\n",
+               path.c_str(), m->batch, m->rows, m->cols, name, batch, rows, cols);
+        matrix_io::unmap_matrix(m);
+        return nullptr;
+    }
+    return m->data;
+}
+
 static void usage(const char *prg) {
-    fprintf(stderr, "Usage: %s N BS mode seed [--print-matrix]\n", prg);
-    fprintf(stderr, "Block modes: avx, scalar, hybrid, interleaved, blas\n");
-    fprintf(stderr, "Whole modes: scalar_whole, blas_whole\n");
+    fprintf(stderr, "Usage: %s N BS mode seed [--print-matrix] [--threads T] [--runner R] [--mc MC --kc KC --nc NC]\n"
+                    "       [--shape MxNxK]   (default: square N x N x N)\n"
+                    "       [--batch COUNT]   (COUNT independent products of the same shape)\n"
+                    "       [--isa auto|avx512_bf16|avx512|avx2|scalar]   (cap the kernel variant picked via cpuid)\n"
+                    "       [--affinity none|compact|scatter|CPU_LIST] [--no-smt]   (pin main + worker threads,\n"
+                    "                         e.g. --affinity 0,2,4-7; --no-smt uses one hardware thread per core)\n"
+                    "       [--schedule static|steal]   (tile distribution of the multithreaded block runner;\n"
+                    "                         steal: per-thread deques, idle threads steal tile groups)\n"
+                    "       [--dtype f64|f32|bf16]   (element type of the block path; f32/bf16 accumulate in float)\n"
+                    "       [--autotune] [--tuning-file PATH]   (with mode auto)\n"
+                    "       [--warmup W] [--repeats R]   (untimed + timed in-process iterations, default 0 and 1)\n"
+                    "       [--format json|csv]   (one structured run record on stdout)\n"
+                    "       [--alloc aligned|thp|huge2m|huge1g] [--numa none|local|interleave]   (A, B, C placement)\n"
+                    "       [--a-file PATH] [--b-file PATH]   (mmap binary inputs instead of the synthetic fill)\n"
+                    "       [--c-file PATH] [--save-inputs PREFIX]   (write C / PREFIX_A.mat, PREFIX_B.mat)\n"
+                    "       [--verify] [--verify-method auto|blas|freivalds] [--verify-tol RTOL]\n"
+                    "                         (check C against blas_whole or a Freivalds test; exit 1 on mismatch)\n", prg);
+    fprintf(stderr, "Block modes: avx, avx_tile, scalar, hybrid, interleaved, blas\n");
+    fprintf(stderr, "  memory hints: avx_pf, interleaved_pf (prefetch next packB rows and C tile),\n"
+                    "  avx_nt, interleaved_nt (plus streaming C stores on the final k-panel; not as leaves)\n");
+    fprintf(stderr, "  tuned variants: hybrid<A,S>, interleaved<A,S> (A AVX ops, S scalar ops per chunk;\n"
+                    "  A in 1..4, S in 1,2,4,8,16, plus hybrid<1,0> and hybrid<0,8>)\n");
+    fprintf(stderr, "Whole modes: scalar_whole, blas_whole, strassen, morton\n");
+    fprintf(stderr, "  strassen: [--strassen-cutoff C] [--strassen-levels L] [--strassen-leaf blas_whole|BLOCK_MODE]\n"
+                    "  (Winograd levels while min(M,N,K) > C, default 512 and 2; a block-mode leaf runs with BS)\n");
+    fprintf(stderr, "  morton: [--morton-leaf BLOCK_MODE]   (Z-order BS x BS tiles, recursive halving down to\n"
+                    "  one tile product with the leaf kernel, default avx)\n");
+    fprintf(stderr, "Panel-packed block modes: avx_packed, scalar_packed\n");
+    fprintf(stderr, "Mode auto: runs the fastest (mode, BS) stored in the per-host tuning file (BS is ignored);\n"
+                    "  --autotune times the candidates for this shape first and stores the winner\n");
+    fprintf(stderr, "Block runners (--runner): block (default), bpanel (pack each B k-panel once),\n"
+                    "  goto (five-loop MC/KC/NC blocking; unset sizes are derived from the cache sizes)\n");
 }
 
 int main(int argc, char **argv) {
     if (argc < 5) { usage(argv[0]); return 1; }
     
-    // Simple argument parsing for the optional flag
+    // Simple argument parsing for the optional flags
     std::vector<std::string> args(argv, argv + argc);
     bool print_output_matrix = false;
-    if (args.size() > 5 && args[5] == "--print-matrix") {
-        print_output_matrix = true;
+    int num_threads = 1;
+    std::string runner = "block";
+    int goto_mc = 0, goto_kc = 0, goto_nc = 0; // 0: derived from the cache sizes
+    std::string shape;
+    int batch = 1;
+    std::string isa_request = "auto";
+    std::string dtype_request = "f64";
+    std::string schedule_request = "static";
+    std::string affinity_request = "none";
+    bool no_smt = false;
+    bool autotune = false;
+    int warmup = 0, repeats = 1;
+    std::string report_format;
+    std::string tuning_file;
+    std::string alloc_request = "aligned", numa_request = "none";
+    std::string a_file, b_file, c_file, save_inputs;
+    bool verify = false;
+    int strassen_cutoff = 512, strassen_max_levels = 2;
+    std::string strassen_leaf = "blas_whole";
+    std::string morton_leaf = "avx";
+    std::string verify_method = "auto";
+    double verify_tol = 0.0; // 0: 1e-10 for blas, the rounding-error bound for freivalds
+    for (size_t a = 5; a < args.size(); ++a) {
+        if (args[a] == "--print-matrix") {
+            print_output_matrix = true;
+        } else if (args[a] == "--threads" && a + 1 < args.size()) {
+            num_threads = std::stoi(args[++a]);
+        } else if (args[a] == "--runner" && a + 1 < args.size()) {
+            runner = args[++a];
+        } else if (args[a] == "--mc" && a + 1 < args.size()) {
+            goto_mc = std::stoi(args[++a]);
+        } else if (args[a] == "--kc" && a + 1 < args.size()) {
+            goto_kc = std::stoi(args[++a]);
+        } else if (args[a] == "--nc" && a + 1 < args.size()) {
+            goto_nc = std::stoi(args[++a]);
+        } else if (args[a] == "--shape" && a + 1 < args.size()) {
+            shape = args[++a];
+        } else if (args[a] == "--batch" && a + 1 < args.size()) {
+            batch = std::stoi(args[++a]);
+        } else if (args[a] == "--isa" && a + 1 < args.size()) {
+            isa_request = args[++a];
+        } else if (args[a] == "--affinity" && a + 1 < args.size()) {
+            affinity_request = args[++a];
+        } else if (args[a] == "--no-smt") {
+            no_smt = true;
+        } else if (args[a] == "--schedule" && a + 1 < args.size()) {
+            schedule_request = args[++a];
+        } else if (args[a] == "--dtype" && a + 1 < args.size()) {
+            dtype_request = args[++a];
+        } else if (args[a] == "--warmup" && a + 1 < args.size()) {
+            warmup = std::stoi(args[++a]);
+        } else if (args[a] == "--repeats" && a + 1 < args.size()) {
+            repeats = std::stoi(args[++a]);
+        } else if (args[a] == "--format" && a + 1 < args.size()) {
+            report_format = args[++a];
+        } else if (args[a] == "--alloc" && a + 1 < args.size()) {
+            alloc_request = args[++a];
+        } else if (args[a] == "--numa" && a + 1 < args.size()) {
+            numa_request = args[++a];
+        } else if (args[a] == "--a-file" && a + 1 < args.size()) {
+            a_file = args[++a];
+        } else if (args[a] == "--b-file" && a + 1 < args.size()) {
+            b_file = args[++a];
+        } else if (args[a] == "--c-file" && a + 1 < args.size()) {
+            c_file = args[++a];
+        } else if (args[a] == "--save-inputs" && a + 1 < args.size()) {
+            save_inputs = args[++a];
+        } else if (args[a] == "--verify") {
+            verify = true;
+        } else if (args[a] == "--verify-method" && a + 1 < args.size()) {
+            verify_method = args[++a];
+            verify = true;
+        } else if (args[a] == "--verify-tol" && a + 1 < args.size()) {
+            verify_tol = std::stod(args[++a]);
+            verify = true;
+        } else if (args[a] == "--strassen-cutoff" && a + 1 < args.size()) {
+            strassen_cutoff = std::stoi(args[++a]);
+        } else if (args[a] == "--strassen-levels" && a + 1 < args.size()) {
+            strassen_max_levels = std::stoi(args[++a]);
+        } else if (args[a] == "--strassen-leaf" && a + 1 < args.size()) {
+            strassen_leaf = args[++a];
+        } else if (args[a] == "--morton-leaf" && a + 1 < args.size()) {
+            morton_leaf = args[++a];
+        } else if (args[a] == "--autotune") {
+            autotune = true;
+        } else if (args[a] == "--tuning-file" && a + 1 < args.size()) {
+            tuning_file = args[++a];
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'.\n", args[a].c_str());
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (num_threads <= 0) {
+        fprintf(stderr, "Error: --threads must be positive.\n");
+        return 1;
+    }
+    if (runner != "block" && runner != "bpanel" && runner != "goto") {
+        fprintf(stderr, "Error: Unknown runner '%s'.\n", runner.c_str());
+        usage(argv[0]);
+        return 1;
+    }
+    const matmul_status isa_status = matmul_limit_isa(isa_request.c_str());
+    if (isa_status == MATMUL_ERR_ARG) {
+        fprintf(stderr, "Error: Unknown ISA '%s'.\n", isa_request.c_str());
+        usage(argv[0]);
+        return 1;
+    }
+    if (isa_status == MATMUL_ERR_UNSUPPORTED) {
+        fprintf(stderr, "Error: --isa %s is not supported by this CPU (best: %s).\n",
+               isa_request.c_str(), isa_name(detect_isa()));
+        return 1;
+    }
+    affinity::Policy affinity_policy;
+    std::vector<int> affinity_list;
+    if (!affinity::parse_policy(affinity_request, &affinity_policy, &affinity_list)) {
+        fprintf(stderr, "Error: Unknown --affinity '%s' (expected none, compact, scatter or a CPU list).\n",
+               affinity_request.c_str());
+        return 1;
+    }
+    if (no_smt && affinity_policy == affinity::Policy::none) {
+        fprintf(stderr, "Error: --no-smt needs an --affinity policy.\n");
+        return 1;
+    }
+    Dtype dtype;
+    if (!parse_dtype(dtype_request, &dtype)) {
+        fprintf(stderr, "Error: Unknown dtype '%s'.\n", dtype_request.c_str());
+        usage(argv[0]);
+        return 1;
+    }
+    const bool low_precision = dtype != Dtype::f64;
+    if (!report_format.empty() && !valid_report_format(report_format)) {
+        fprintf(stderr, "Error: Unknown format '%s' (expected json or csv).\n", report_format.c_str());
+        return 1;
+    }
+    if (!report_format.empty() && print_output_matrix) {
+        fprintf(stderr, "Error: --format and --print-matrix both write to stdout; pick one.\n");
+        return 1;
+    }
+    matrix_utils::PagePolicy page_policy;
+    matrix_utils::NumaPolicy numa_policy;
+    if (!matrix_utils::parse_page_policy(alloc_request, &page_policy)) {
+        fprintf(stderr, "Error: Unknown --alloc policy '%s'.\n", alloc_request.c_str());
+        usage(argv[0]);
+        return 1;
+    }
+    if (!matrix_utils::parse_numa_policy(numa_request, &numa_policy)) {
+        fprintf(stderr, "Error: Unknown --numa policy '%s'.\n", numa_request.c_str());
+        usage(argv[0]);
+        return 1;
+    }
+    if (verify_method != "auto" && verify_method != "blas" && verify_method != "freivalds") {
+        fprintf(stderr, "Error: Unknown --verify-method '%s'.\n", verify_method.c_str());
+        usage(argv[0]);
+        return 1;
+    }
+    if (!(verify_tol >= 0.0)) {
+        fprintf(stderr, "Error: --verify-tol must be non-negative.\n");
+        return 1;
+    }
+    if (warmup < 0 || repeats <= 0) {
+        fprintf(stderr, "Error: --warmup must be >= 0 and --repeats positive.\n");
+        return 1;
+    }
+    if (batch <= 0) {
+        fprintf(stderr, "Error: --batch must be positive.\n");
+        return 1;
     }
 
     int N = std::stoi(args[1]);
@@ -41,60 +267,423 @@ int main(int argc, char **argv) {
     std::string mode = args[3];
     unsigned int seed = std::stoul(args[4]);
 
-    if (N % 8 != 0) {
-        fprintf(stderr, "Error: N must be a multiple of 8.\n");
+    int M = N, K = N;
+    if (!shape.empty() && sscanf(shape.c_str(), "%dx%dx%d", &M, &N, &K) != 3) {
+        fprintf(stderr, "Error: --shape expects MxNxK (e.g. 16384x256x256).\n");
         return 1;
     }
+    if (M <= 0 || N <= 0 || K <= 0) {
+        fprintf(stderr, "Error: M, N and K must be positive.\n");
+        return 1;
+    }
+    const GemmDims dims = make_gemm_dims(M, N, K);
 
-    double *A = matrix_utils::alloc(N);
-    double *B = matrix_utils::alloc(N);
-    double *C = matrix_utils::alloc(N);
+    // Batch entries are stored back to back (strided batch); batch == 1 is the plain case
+    const size_t a_elems = size_t(M) * K, b_elems = size_t(K) * N, c_elems = size_t(M) * N;
+    // The stacked row count is an int in the matrix files, and the bytes must fit a size_t
+    const size_t stacked_rows = size_t(batch) * size_t(std::max(M, K));
+    const size_t max_elems = std::max(a_elems, std::max(b_elems, c_elems));
+    if (stacked_rows > size_t(INT32_MAX) || max_elems > SIZE_MAX / sizeof(double) / size_t(batch)) {
+        fprintf(stderr, "Error: --batch %d of %d x %d x %d products is too large.\n", batch, M, N, K);
+        return 1;
+    }
+    // Pin before anything is first-touched, so the pages land next to their threads
+    std::vector<int> pinned_cpus;
+    if (affinity_policy != affinity::Policy::none) {
+        bool shared = false;
+        std::string err;
+        if (!affinity::plan(affinity_policy, affinity_list, no_smt, num_threads, &pinned_cpus, &shared, &err)) {
+            fprintf(stderr, "Error: --affinity %s: %s.\n", affinity_request.c_str(), err.c_str());
+            return 1;
+        }
+        if (shared) {
+            fprintf(stderr, "Warning: %d threads share the %s CPUs %s.\n", num_threads,
+                   affinity::policy_name(affinity_policy), affinity::format_cpus(pinned_cpus).c_str());
+        }
+        if (!affinity::pin_threads(pinned_cpus, num_threads)) {
+            perror("Error: pthread_setaffinity_np");
+            return 1;
+        }
+    }
+
+    // File inputs are mapped zero-copy. C is zeroed by a parallel first touch, so it starts
+    // out cleared; for synthetic A and B the parallel fill is the first touch.
+    auto setup_t0 = std::chrono::steady_clock::now();
+    matrix_io::MappedMatrix a_map, b_map;
+    matrix_utils::PagePolicy granted_a, granted_b, granted_c;
+    double *A = nullptr, *B = nullptr;
+    if (!a_file.empty()) {
+        if (!(A = map_operand(a_file, "A", M, K, batch, &a_map))) return 1;
+    } else {
+        A = matrix_utils::alloc_matrix(size_t(batch) * M, K, page_policy, numa_policy, num_threads, &granted_a, false);
+    }
+    if (!b_file.empty()) {
+        if (!(B = map_operand(b_file, "B", K, N, batch, &b_map))) return 1;
+    } else {
+        B = matrix_utils::alloc_matrix(size_t(batch) * K, N, page_policy, numa_policy, num_threads, &granted_b, false);
+    }
+    double *C = matrix_utils::alloc_matrix(size_t(batch) * M, N, page_policy, numa_policy, num_threads, &granted_c);
     if (!A || !B || !C) { perror("alloc"); return 1; }
+    const char *a_backing = a_map.data ? "file" : matrix_utils::page_policy_name(granted_a);
+    const char *b_backing = b_map.data ? "file" : matrix_utils::page_policy_name(granted_b);
+    if (page_policy != matrix_utils::PagePolicy::aligned || numa_policy != matrix_utils::NumaPolicy::none) {
+        fprintf(stderr, "ALLOC\tpages=%s\tnuma=%s\tA=%s\tB=%s\tC=%s\n",
+               matrix_utils::page_policy_name(page_policy), matrix_utils::numa_policy_name(numa_policy),
+               a_backing, b_backing, matrix_utils::page_policy_name(granted_c));
+    }
 
-    matrix_utils::fill(A, N);
-    matrix_utils::fill(B, N);
-    memset(C, 0, sizeof(double)*size_t(N)*size_t(N));
+    const double alloc_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - setup_t0).count();
 
-    papito_init();
-    papito_start();
-    auto t0 = std::chrono::high_resolution_clock::now();
+    // Seeded synthetic operands: A and B are independent streams, and every batch entry
+    // gets its own values
+    auto fill_t0 = std::chrono::steady_clock::now();
+    if (!a_map.data) matrix_utils::fill(A, a_elems * batch, seed, 0, num_threads);
+    if (!b_map.data) matrix_utils::fill(B, b_elems * batch, seed, 1, num_threads);
+    const double fill_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - fill_t0).count();
+    // Reduced-precision runs compute on float copies of the double operands (bf16 rounding
+    // happens while packing); C is converted back to double after the timed repeats
+    std::vector<float> Af, Bf, Cf;
+    if (low_precision) {
+        Af.assign(A, A + a_elems * batch);
+        Bf.assign(B, B + b_elems * batch);
+        Cf.assign(c_elems * batch, 0.0f);
+    }
+    if (!save_inputs.empty()) {
+        std::string err;
+        if (!matrix_io::write_matrix(save_inputs + "_A.mat", A, M, K, batch, &err) ||
+            !matrix_io::write_matrix(save_inputs + "_B.mat", B, K, N, batch, &err)) {
+            fprintf(stderr, "Error: %s\n", err.c_str());
+            return 1;
+        }
+    }
 
-    // --- Dispatch Logic ---
-    matmul_whole_func_t whole_kernel = get_kernel_for_mode_whole(mode);
-    if (whole_kernel) {
-        run_benchmark_whole_matrix(A, B, C, N, whole_kernel);
-    } else {
-        matmul_func_t block_kernel = get_kernel_for_mode(mode);
-        if (block_kernel) {
-            if (BS <= 0 || N % BS != 0) {
-                fprintf(stderr, "Error: For block modes, BS must be a positive divisor of N.\n");
+    // mode auto resolves to a tuned (mode, BS) before anything is measured
+    if (mode == "auto" && low_precision) {
+        fprintf(stderr, "Error: mode auto only tunes the f64 kernels.\n");
+        return 1;
+    }
+    if (mode == "auto") {
+        if (runner != "block" || batch > 1) {
+            fprintf(stderr, "Error: mode auto only supports the default runner without --batch.\n");
+            return 1;
+        }
+        if (tuning_file.empty()) tuning_file = default_tuning_file();
+        TunedConfig tuned;
+        if (autotune) {
+            if (!autotune_search(A, B, C, dims, num_threads, &tuned)) {
+                fprintf(stderr, "Error: Autotuning found no usable candidate.\n");
                 return 1;
             }
-            run_benchmark(A, B, C, N, BS, block_kernel);
-        } else {
-            fprintf(stderr, "Error: Unknown mode '%s'.\n", mode.c_str());
-            usage(argv[0]);
+            if (!save_tuned_config(tuning_file, dims, effective_isa(), num_threads, tuned)) {
+                fprintf(stderr, "Error: Could not write tuning file '%s'.\n", tuning_file.c_str());
+                return 1;
+            }
+        } else if (!load_tuned_config(tuning_file, dims, effective_isa(), num_threads, &tuned)) {
+            fprintf(stderr, "Error: No tuned entry for %dx%dx%d (isa=%s threads=%d) in '%s'; run with --autotune first.\n",
+                   M, N, K, isa_name(effective_isa()), num_threads, tuning_file.c_str());
             return 1;
         }
+        fprintf(stderr, "AUTOTUNE\tfile=%s\ttuned=%d\tmode=%s\tBS=%d\tbest_s=%g\n",
+               tuning_file.c_str(), autotune ? 1 : 0, tuned.mode.c_str(), tuned.BS, tuned.seconds);
+        mode = tuned.mode;
+        BS = tuned.BS;
+    } else if (autotune) {
+        fprintf(stderr, "Error: --autotune requires mode auto.\n");
+        return 1;
+    }
+
+    // The product itself runs through the library's C API (matmul.h); the CLI adds the
+    // operands, the repeats and the reports around it
+    matmul_ctx *ctx = nullptr;
+    matmul_status status = matmul_create(num_threads, MATMUL_COUNTERS | MATMUL_COUNTERS_REPORT, &ctx);
+    if (status != MATMUL_OK) {
+        // Only MATMUL_ERR_COUNTERS is about PAPI, and its string says so
+        fprintf(stderr, "Error: %s.\n", matmul_status_string(status));
+        return 1;
+    }
+    status = matmul_set_dtype(ctx, dtype_name(dtype));
+    if (status == MATMUL_OK) status = matmul_set_runner(ctx, runner.c_str(), goto_mc, goto_kc, goto_nc);
+    if (status == MATMUL_OK) {
+        status = matmul_set_strassen(ctx, strassen_cutoff, strassen_max_levels, strassen_leaf.c_str());
+    }
+    if (status == MATMUL_OK) status = matmul_set_morton_leaf(ctx, morton_leaf.c_str());
+    if (status == MATMUL_OK) status = matmul_set_schedule(ctx, schedule_request.c_str());
+    if (status == MATMUL_OK) status = matmul_select(ctx, mode.c_str(), BS);
+    if (status == MATMUL_OK) status = matmul_reserve(ctx, M, N, K, batch);
+    if (status != MATMUL_OK) {
+        fprintf(stderr, "Error: %s.\n", matmul_last_error(ctx));
+        return 1;
+    }
+    const char *kernel_isa = matmul_selected_isa(ctx);
+    const std::string runner_name = matmul_selected_runner(ctx);
+    if (runner_name == "goto") {
+        int mc = 0, kc = 0, nc = 0;
+        long l1d = 0, l2 = 0, l3 = 0;
+        matmul_runner_blocking(ctx, M, N, K, &mc, &kc, &nc);
+        papito_cache_sizes(&l1d, &l2, &l3);
+        fprintf(stderr, "BLOCKING\tMC=%d\tKC=%d\tNC=%d\tL1d=%ld\tL2=%ld\tL3=%ld\n", mc, kc, nc, l1d, l2, l3);
+    }
+
+    // A strided batch over the (float copies of the) operands. C starts out zeroed and is
+    // cleared between products outside the timed calls, so the library does not clear it.
+    matmul_gemm_desc gemm = {};
+    gemm.M = M; gemm.N = N; gemm.K = K;
+    gemm.A = low_precision ? static_cast<const void*>(Af.data()) : A;
+    gemm.B = low_precision ? static_cast<const void*>(Bf.data()) : B;
+    gemm.C = low_precision ? static_cast<void*>(Cf.data()) : C;
+    gemm.lda = dims.lda; gemm.ldb = dims.ldb; gemm.ldc = dims.ldc;
+    gemm.stride_a = a_elems; gemm.stride_b = b_elems; gemm.stride_c = c_elems;
+    gemm.batch = batch;
+    gemm.flags = MATMUL_C_ZEROED;
+    auto run_once = [&]() {
+        if (matmul_gemm(ctx, &gemm) == MATMUL_OK) return true;
+        fprintf(stderr, "Error: %s.\n", matmul_last_error(ctx));
+        return false;
+    };
+    auto clear_c = [&]() {
+        if (low_precision) {
+            memset(Cf.data(), 0, sizeof(float) * Cf.size());
+        } else {
+            memset(C, 0, sizeof(double)*c_elems*size_t(batch));
+        }
+    };
+    // Block runners take their packing buffers from a per-thread arena, sized by matmul_reserve
+    const long arena_growths = matmul_workspace_growths();
+
+    // Warm-up iterations touch every page and warm the caches outside the measured region
+    for (int w = 0; w < warmup; ++w) {
+        if (!run_once()) return 1;
+        clear_c();
     }
 
-    auto t1 = std::chrono::high_resolution_clock::now();
-    papito_end();
+    // Counters cover all timed repeats; C is re-zeroed between them, so the final C and
+    // checksum are those of a single product
+    std::vector<double> samples;
+    matmul_reset_stats(ctx);
+    // RAPL energy brackets the same repeats (C clearing between them included)
+    std::vector<energy::Domain> energy_domains;
+    std::vector<uint64_t> energy_before, energy_after;
+    std::string energy_error;
+    bool have_energy = energy::discover(&energy_domains, &energy_error);
+    matmul_counters_begin(ctx);
+    auto energy_t0 = std::chrono::steady_clock::now();
+    if (have_energy) have_energy = energy::read_uj(energy_domains, &energy_before);
+    for (int r = 0; r < repeats; ++r) {
+        if (r > 0) clear_c();
+        if (!run_once()) return 1;
+        samples.push_back(matmul_last_seconds(ctx));
+    }
+    if (have_energy) have_energy = energy::read_uj(energy_domains, &energy_after);
+    const double energy_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - energy_t0).count();
+    if (!have_energy && energy_error.empty()) energy_error = "energy_uj read failed";
+    matmul_counters_end(ctx);
+    // The checksum pass runs after the counters stop, so its pass over C stays out of them
+    auto checksum_t0 = std::chrono::steady_clock::now();
+    const double s = low_precision ? matrix_utils::checksum(Cf.data(), Cf.size(), num_threads)
+                                   : matrix_utils::checksum(C, c_elems * batch, num_threads);
+    const double checksum_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - checksum_t0).count();
+    // From here on (verify, --print-matrix, --c-file) C holds the widened result
+    if (low_precision) std::copy(Cf.begin(), Cf.end(), C);
+    if (runner_name != "whole") {
+        fprintf(stderr, "WORKSPACE\tgrowths=%ld\ttimed_growths=%ld\n",
+               matmul_workspace_growths(), matmul_workspace_growths() - arena_growths);
+    }
     
     // All logging and summary info goes to stderr
-    std::chrono::duration<double> elapsed = t1 - t0;
-    double s = 0.0;
-    for (long i=0;i<(long)N*N;++i) s += C[i];
+    const TimingStats st = compute_timing_stats(samples);
+    const double flops = 2.0 * double(M) * double(N) * double(K) * batch;
     
     fprintf(stderr, "done sum=%g\n", s);
-    fprintf(stderr, "SUMMARY\tN=%d\tBS=%d\tmode=%s\tseed=%u\tseconds=%g\tchecksum=%g\n",
-           N, BS, mode.c_str(), seed, elapsed.count(), s);
+    // seconds= is the median; the other timing fields must not end in "seconds=" (scripts match it greedily)
+    fprintf(stderr, "SUMMARY\tN=%d\tBS=%d\tmode=%s\tseed=%u\tseconds=%g\tchecksum=%g\tthreads=%d\tM=%d\tK=%d\tisa=%s\tdtype=%s"
+                    "\twarmup=%d\trepeats=%d\tmin_s=%g\tmedian_s=%g\tp95_s=%g\tstddev_s=%g\tgflops=%g\n",
+           N, BS, mode.c_str(), seed, st.median, s, num_threads, M, K, kernel_isa, dtype_name(dtype),
+           warmup, repeats, st.min, st.median, st.p95, st.stddev, st.median > 0.0 ? flops / st.median * 1e-9 : 0.0);
+    if (affinity_policy != affinity::Policy::none) {
+        // observed= is where the threads run after the repeats; it differs from cpus= only
+        // if something re-pinned them
+        fprintf(stderr, "AFFINITY\tpolicy=%s\tsmt=%s\tcpus=%s\tobserved=%s\n",
+               affinity::policy_name(affinity_policy), no_smt ? "off" : "on",
+               affinity::format_cpus(pinned_cpus).c_str(),
+               affinity::format_cpus(affinity::current_cpus(num_threads)).c_str());
+    }
+    // joules is per repeat (package + DRAM); watts averages over the whole bracketed interval
+    double energy_j = NAN, energy_w = NAN, gflops_per_j = NAN;
+    if (have_energy) {
+        const energy::Energy e = energy::consumed(energy_domains, energy_before, energy_after);
+        const double total_j = e.package_joules + e.dram_joules;
+        energy_j = total_j / repeats;
+        energy_w = energy_s > 0.0 ? total_j / energy_s : NAN;
+        gflops_per_j = energy_j > 0.0 ? flops * 1e-9 / energy_j : NAN;
+        char dram_text[32] = "NA";
+        if (e.have_dram) snprintf(dram_text, sizeof(dram_text), "%g", e.dram_joules / repeats);
+        fprintf(stderr, "ENERGY\tsource=powercap\tdomains=%s\tjoules=%g\tpkg_j=%g\tdram_j=%s\twatts=%g"
+                        "\tgflops_per_j=%g\tinterval_s=%g\trepeats=%d\n",
+               energy::format_domains(energy_domains).c_str(), energy_j, e.package_joules / repeats,
+               dram_text, energy_w, gflops_per_j, energy_s, repeats);
+        if (energy_s < energy::MIN_RELIABLE_SECONDS) {
+            fprintf(stderr, "Warning: the energy interval (%g s) spans few RAPL updates; "
+                            "raise --repeats for a trustworthy GFLOP/J.\n", energy_s);
+        }
+    } else {
+        fprintf(stderr, "ENERGY\tsource=none\treason=%s\n", energy_error.c_str());
+    }
+    // Untimed work around the measured repeats
+    fprintf(stderr, "SETUP\talloc_s=%g\tfill_s=%g\tchecksum_s=%g\tthreads=%d\n",
+           alloc_s, fill_s, checksum_s, num_threads);
+    // busy_s is per repeat; tiles and steals are summed over the repeats.
+    // imbalance = slowest thread's busy time / mean busy time (1 = perfectly balanced)
+    double sched_imbalance = NAN;
+    long sched_steals = 0;
+    int task_tiles = 0, sched_threads = 0;
+    long sched_tasks = 0;
+    const bool parallel_tiles = matmul_schedule_stats(ctx, &task_tiles, &sched_tasks, &sched_threads) == MATMUL_OK;
+    if (parallel_tiles) {
+        std::vector<double> busy(sched_threads);
+        std::vector<long> tiles(sched_threads), steals(sched_threads);
+        double busy_max = 0.0, busy_sum = 0.0;
+        for (int t = 0; t < sched_threads; ++t) {
+            matmul_schedule_thread(ctx, t, &busy[t], &tiles[t], &steals[t]);
+            busy[t] /= repeats;
+            busy_max = std::max(busy_max, busy[t]);
+            busy_sum += busy[t];
+            sched_steals += steals[t];
+        }
+        const double busy_mean = busy_sum / num_threads;
+        sched_imbalance = busy_mean > 0.0 ? busy_max / busy_mean : NAN;
+        fprintf(stderr, "SCHEDULE\tpolicy=%s\ttask_tiles=%d\ttasks=%ld\tsteals=%ld\tbusy_max_s=%g\tbusy_mean_s=%g"
+                        "\timbalance=%.4f\trepeats=%d\n",
+               schedule_request.c_str(), task_tiles, sched_tasks, sched_steals,
+               busy_max, busy_mean, sched_imbalance, repeats);
+        for (int t = 0; t < sched_threads; ++t) {
+            fprintf(stderr, "SCHEDULE_THREAD\tthread=%d\tbusy_s=%g\ttiles=%ld\tsteals=%ld\n",
+                   t, busy[t], tiles[t], steals[t]);
+        }
+    }
+    // Per repeat; the library sums them over the timed calls
+    double pack_s = 0.0, kernel_s = 0.0;
+    const bool have_phase_times = matmul_phase_seconds(ctx, &pack_s, &kernel_s) == MATMUL_OK;
+    pack_s /= repeats;
+    kernel_s /= repeats;
+    if (have_phase_times) {
+        double phase_total = pack_s + kernel_s;
+        fprintf(stderr, "PHASES\trunner=%s\tpack_s=%g\tkernel_s=%g\tpack_pct=%.2f\n",
+               runner.c_str(), pack_s, kernel_s, phase_total > 0.0 ? 100.0 * pack_s / phase_total : 0.0);
+    }
+    // whole-matrix kernels (BLAS) are rated against the best ISA of the host
+    IsaLevel roof_isa = effective_isa();
+    if (runner_name != "whole") parse_isa(kernel_isa, &roof_isa);
+    const RooflineResult roof = compute_roofline(dims, batch, num_threads, repeats, roof_isa,
+                                                 flops, st.median, papito_last_results(), dtype);
+    fprintf(stderr, "ROOFLINE\tgflops=%g\tpeak_gflops=%g\tpeak_pct=%.2f\tflops_per_cycle=%g\tghz=%g"
+                    "\tl2_bytes=%g\tdram_bytes=%g\tdram_source=%s\tai_l2=%g\tai_dram=%g"
+                    "\tl2_roof_gflops=%g\tdram_roof_gflops=%g\tbound=%s\n",
+           roof.gflops, roof.peak_gflops, 100.0 * roof.peak_share, roof.flops_per_cycle, roof.ghz,
+           roof.l2_bytes, roof.dram_bytes, roof.dram_from_counters ? "counters" : "compulsory",
+           roof.ai_l2, roof.ai_dram, roof.l2_roof_gflops, roof.dram_roof_gflops, roof.bound.c_str());
+    if (mode == "strassen") {
+        // Measured error against blas_whole (rtol = 1 only collects the maxima)
+        VerifyResult err;
+        if (!verify_blas(A, B, C, dims, batch, 1.0, &err)) { perror("verify"); return 1; }
+        StrassenConfig cfg;
+        cfg.cutoff = strassen_cutoff;
+        cfg.max_levels = strassen_max_levels;
+        fprintf(stderr, "STRASSEN\tlevels=%d\tcutoff=%d\tleaf=%s\tflop_ratio=%.4f\tmax_abs_err=%g\tmax_rel_err=%g\n",
+               strassen_levels(cfg, dims), strassen_cutoff, strassen_leaf.c_str(),
+               strassen_flops(cfg, dims) / (2.0 * double(M) * N * K), err.max_abs, err.max_rel);
+    }
+    if (mode == "morton") {
+        MortonConfig cfg;
+        cfg.leaf_bs = BS;
+        const MortonGrid g = morton_grid(cfg, dims);
+        fprintf(stderr, "MORTON\tleaf=%s\ttile=%d\ttiles=%dx%dx%d\tpadded=%dx%dx%d\tlayout_mib=%.2f\n",
+               morton_leaf.c_str(), BS, g.mt, g.nt, g.kt, g.mt_pad, g.nt_pad, g.kt_pad,
+               morton_layout_bytes(cfg, dims) / (1024.0 * 1024.0));
+    }
+    VerifyResult check;
+    if (verify) {
+        // Reduced-precision errors are only meaningful against |A||B|, so they get freivalds
+        if (verify_method == "auto") {
+            verify_method = !low_precision && double(M) * N * K * batch <= VERIFY_BLAS_MAX_FMAS ? "blas" : "freivalds";
+        }
+        // The freivalds rounding bound with the float unit roundoff; bf16 adds the rounding of
+        // both inputs to 8 significant bits (2 * 2^-8)
+        if (verify_tol == 0.0 && low_precision) {
+            verify_tol = (2.0 * K + N + 4) * (FLT_EPSILON / 2) + (dtype == Dtype::bf16 ? 0x1p-7 : 0.0);
+        }
+        if (verify_method == "blas" && verify_tol == 0.0) verify_tol = 1e-10;
+        bool ran = verify_method == "blas"
+            ? verify_blas(A, B, C, dims, batch, verify_tol, &check)
+            : verify_freivalds(A, B, C, dims, batch, verify_tol, seed, 2, &check);
+        if (!ran) { perror("verify"); return 1; }
+        char tol_text[32] = "bound";
+        if (verify_tol > 0.0) snprintf(tol_text, sizeof(tol_text), "%g", verify_tol);
+        fprintf(stderr, "VERIFY\tmethod=%s\tstatus=%s\trtol=%s\tmax_abs=%g\tmax_rel=%g\tmismatches=%ld"
+                        "\tfirst_batch=%d\tfirst_row=%d\tfirst_col=%d\n",
+               check.method.c_str(), check.ok ? "PASS" : "FAIL",
+               tol_text, check.max_abs, check.max_rel,
+               check.mismatches, check.first_batch, check.first_row, check.first_col);
+    }
+    if (batch > 1) {
+        double secs = st.median;
+        fprintf(stderr, "BATCH\tcount=%d\tper_matrix_us=%g\tmatrices_per_s=%g\tgflops=%g\n",
+               batch, 1e6 * secs / batch, secs > 0.0 ? batch / secs : 0.0,
+               secs > 0.0 ? flops / secs * 1e-9 : 0.0);
+    }
+
+    if (!report_format.empty()) {
+        RunReport rep;
+        rep.N = N; rep.M = M; rep.K = K; rep.BS = BS;
+        rep.mode = mode;
+        rep.runner = runner_name;
+        rep.isa = kernel_isa;
+        rep.dtype = dtype_name(dtype);
+        rep.seed = seed;
+        rep.alloc = a_backing;
+        rep.numa = matrix_utils::numa_policy_name(numa_policy);
+        rep.affinity = affinity::policy_name(affinity_policy);
+        rep.cpus = affinity::format_cpus(pinned_cpus);
+        rep.energy_source = have_energy ? "powercap" : "none";
+        rep.energy_joules = energy_j;
+        rep.energy_watts = energy_w;
+        rep.gflops_per_joule = gflops_per_j;
+        if (parallel_tiles) {
+            rep.schedule = schedule_request;
+            rep.sched_steals = double(sched_steals);
+            rep.sched_imbalance = sched_imbalance;
+        }
+        rep.threads = num_threads; rep.batch = batch; rep.warmup = warmup; rep.repeats = repeats;
+        rep.timing = st;
+        rep.checksum = s;
+        rep.alloc_seconds = alloc_s;
+        rep.fill_seconds = fill_s;
+        rep.checksum_seconds = checksum_s;
+        rep.flops = flops;
+        rep.have_phases = have_phase_times;
+        rep.pack_seconds = pack_s;
+        rep.kernel_seconds = kernel_s;
+        rep.roofline = roof;
+        rep.verify = verify;
+        rep.verify_result = check;
+        write_run_report(stdout, report_format, rep, papito_last_results());
+    }
 
     // If requested, print the final matrix to stdout
     if (print_output_matrix) {
-        print_matrix(C, N);
+        for (int b = 0; b < batch; ++b) print_matrix(C + b * c_elems, M, N, dims.ldc);
+    }
+
+    if (!c_file.empty()) {
+        std::string err;
+        if (!matrix_io::write_matrix(c_file, C, M, N, batch, &err)) {
+            fprintf(stderr, "Error: %s\n", err.c_str());
+            return 1;
+        }
     }
 
-    free(A); free(B); free(C);
-    return 0;
+    if (a_map.data) matrix_io::unmap_matrix(&a_map); else matrix_utils::release(A);
+    if (b_map.data) matrix_io::unmap_matrix(&b_map); else matrix_utils::release(B);
+    matrix_utils::release(C);
+    matmul_destroy(ctx);
+    return check.ok ? 0 : 1;
 }
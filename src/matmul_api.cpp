@@ -0,0 +1,576 @@
+#include "matmul.h"
+#include "cpu_features.h"
+#include "dispatch_kernels.h"
+#include "dispatch_kernels_packed.h"
+#include "dispatch_kernels_whole.h"
+#include "dtype.h"
+#include "morton.h"
+#include "pack_arena.h"
+#include "papito.h"
+#include "runner.h"
+#include "runner_packed.h"
+#include "runner_whole.h"
+#include "strassen.h"
+#include "tile_scheduler.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+struct matmul_ctx {
+    int num_threads = 1;
+    bool counters = false;
+    bool report = false;           // MATMUL_COUNTERS_REPORT
+    bool in_session = false;       // between matmul_counters_begin and _end
+    // Configuration of the next matmul_select
+    Dtype dtype = Dtype::f64;
+    std::string runner = "block";
+    GotoBlocking blocking;         // as set; 0 sizes are derived per shape
+    long l2_bytes = 0, l3_bytes = 0;
+    StrassenConfig strassen;
+    std::string strassen_leaf = "blas_whole";
+    std::string morton_leaf = "avx";
+    // Selected kernel (at most one is set)
+    int BS = 0;
+    matmul_func_t block_kernel = nullptr;
+    matmul_packed_func_t packed_kernel = nullptr;
+    matmul_whole_func_t whole_kernel = nullptr;
+    StrassenConfig strassen_run;   // with the leaf resolved, used while strassen is selected
+    MortonConfig morton_run;       // likewise for morton
+    matmul_f32_func_t f32_kernel = nullptr;
+    matmul_bf16_func_t bf16_kernel = nullptr;
+    const char *isa = nullptr;
+    TileSchedule schedule = TileSchedule::static_split;
+    // Results
+    double last_seconds = 0.0;
+    RunnerPhaseTimes phases;       // summed since matmul_reset_stats
+    SchedStats sched;
+    bool have_sched = false;
+    TileQueues queues;             // deques of the steal schedule, owned per context
+    std::vector<std::string> counter_names;
+    std::vector<long long> counter_values;
+    std::string error;
+    // Batch entry pointers handed to the batched runners (grow-only)
+    std::vector<const double*> batch_a, batch_b;
+    std::vector<double*> batch_c;
+    std::vector<const float*> batch_af, batch_bf;
+    std::vector<float*> batch_cf;
+};
+
+static const char *const STATUS_NAMES[] = {
+    "ok", "invalid argument", "unknown or unsupported mode", "no kernel selected",
+    "workspace allocation failed", "instruction set not supported by this CPU",
+    "PAPI counters could not be initialised",
+};
+
+static const int REGION_GEMM = papito_region_id("gemm");
+
+// Contexts with counters share the process-wide PAPI state; the last one releases it
+static int counting_contexts = 0;
+
+// Records why a call on ctx failed and returns status
+static matmul_status fail(matmul_ctx *ctx, matmul_status status, const char *fmt, ...) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    ctx->error = buf;
+    return status;
+}
+
+int matmul_api_version(void) { return MATMUL_API_VERSION; }
+
+const char *matmul_status_string(matmul_status status) {
+    const int i = int(status);
+    return i >= 0 && i < int(sizeof(STATUS_NAMES) / sizeof(STATUS_NAMES[0])) ? STATUS_NAMES[i] : "unknown status";
+}
+
+matmul_status matmul_limit_isa(const char *isa) {
+    if (!isa || strcmp(isa, "auto") == 0) {
+        set_isa_limit(IsaLevel::avx512_bf16);
+        return MATMUL_OK;
+    }
+    IsaLevel limit;
+    if (!parse_isa(isa, &limit)) return MATMUL_ERR_ARG;
+    if (limit > detect_isa()) return MATMUL_ERR_UNSUPPORTED;
+    set_isa_limit(limit);
+    return MATMUL_OK;
+}
+
+matmul_status matmul_create(int num_threads, int counters, matmul_ctx **out) {
+    if (!out || num_threads <= 0) return MATMUL_ERR_ARG;
+    matmul_ctx *ctx = new (std::nothrow) matmul_ctx;
+    if (!ctx) return MATMUL_ERR_ALLOC;
+    ctx->num_threads = num_threads;
+    ctx->counters = (counters & MATMUL_COUNTERS) != 0;
+    ctx->report = ctx->counters && (counters & MATMUL_COUNTERS_REPORT) != 0;
+    if (ctx->counters) {
+        // Library callers query the values; only the CLI asks for the PAPITO_* lines
+        papito_set_quiet(ctx->report ? 0 : 1);
+        if (papito_try_init() != PAPITO_OK) {
+            delete ctx;
+            return MATMUL_ERR_COUNTERS;
+        }
+        ++counting_contexts;
+    }
+    *out = ctx;
+    return MATMUL_OK;
+}
+
+void matmul_destroy(matmul_ctx *ctx) {
+    if (ctx && ctx->counters) {
+        if (ctx->in_session) papito_end();
+        if (--counting_contexts == 0) papito_finalize();
+    }
+    delete ctx;
+}
+
+const char *matmul_last_error(const matmul_ctx *ctx) { return ctx ? ctx->error.c_str() : ""; }
+
+matmul_status matmul_set_dtype(matmul_ctx *ctx, const char *dtype) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (!dtype || !parse_dtype(dtype, &ctx->dtype)) {
+        return fail(ctx, MATMUL_ERR_ARG, "unknown dtype '%s'", dtype ? dtype : "(null)");
+    }
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+matmul_status matmul_set_runner(matmul_ctx *ctx, const char *runner, int mc, int kc, int nc) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    const std::string name = runner ? runner : "(null)";
+    if (name != "block" && name != "bpanel" && name != "goto") {
+        return fail(ctx, MATMUL_ERR_ARG, "unknown runner '%s'", name.c_str());
+    }
+    if (name != "block" && ctx->num_threads > 1) {
+        return fail(ctx, MATMUL_ERR_MODE, "runner %s is single-threaded", name.c_str());
+    }
+    if (mc < 0 || kc < 0 || nc < 0) return fail(ctx, MATMUL_ERR_ARG, "MC, KC and NC must not be negative");
+    ctx->runner = name;
+    ctx->blocking.MC = mc;
+    ctx->blocking.KC = kc;
+    ctx->blocking.NC = nc;
+    if (name == "goto") {
+        long l1d = 0;
+        papito_cache_sizes(&l1d, &ctx->l2_bytes, &ctx->l3_bytes);
+    }
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+matmul_status matmul_set_strassen(matmul_ctx *ctx, int cutoff, int max_levels, const char *leaf) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (cutoff < 1 || max_levels < 0) {
+        return fail(ctx, MATMUL_ERR_ARG, "the strassen cutoff must be positive and the level count non-negative");
+    }
+    ctx->strassen.cutoff = cutoff;
+    ctx->strassen.max_levels = max_levels;
+    ctx->strassen_leaf = leaf ? leaf : "blas_whole";
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+matmul_status matmul_set_morton_leaf(matmul_ctx *ctx, const char *leaf) {
+    if (!ctx || !leaf) return MATMUL_ERR_ARG;
+    ctx->morton_leaf = leaf;
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+// A streaming leaf would evict C tiles that are accumulated or combined again
+static bool is_streaming_kernel(matmul_func_t k) {
+    return k == kernel_avx_nt || k == kernel_interleaved_nt;
+}
+
+matmul_status matmul_select(matmul_ctx *ctx, const char *mode, int bs) {
+    if (!ctx || !mode) return MATMUL_ERR_ARG;
+    const std::string name = mode;
+    IsaLevel chosen = IsaLevel::scalar;
+    matmul_whole_func_t whole = nullptr;
+    matmul_func_t block = nullptr;
+    matmul_packed_func_t packed = nullptr;
+    matmul_f32_func_t f32 = nullptr;
+    matmul_bf16_func_t bf16 = nullptr;
+    if (ctx->dtype != Dtype::f64) {
+        if (ctx->dtype == Dtype::f32) {
+            f32 = get_kernel_for_mode_f32(name, &chosen);
+        } else {
+            bf16 = get_kernel_for_mode_bf16(name, &chosen);
+        }
+        if (!f32 && !bf16) {
+            return fail(ctx, MATMUL_ERR_MODE, "mode '%s' has no %s variant (supported: avx, scalar)",
+                        name.c_str(), dtype_name(ctx->dtype));
+        }
+        if (bs <= 0 || (bf16 && bs % 2 != 0)) {
+            return fail(ctx, MATMUL_ERR_ARG, "for block modes, BS must be positive (and even for bf16)");
+        }
+        if (ctx->runner != "block") {
+            return fail(ctx, MATMUL_ERR_MODE, "dtype %s only supports the block runner", dtype_name(ctx->dtype));
+        }
+    } else if (!(whole = get_kernel_for_mode_whole(name))) {
+        block = get_kernel_for_mode(name, &chosen);
+        if (!block) packed = get_kernel_for_mode_packed(name, &chosen);
+        if (!block && !packed) return fail(ctx, MATMUL_ERR_MODE, "unknown mode '%s'", name.c_str());
+        if (bs <= 0) return fail(ctx, MATMUL_ERR_ARG, "for block modes, BS must be positive");
+        if (packed && (ctx->runner != "block" || ctx->num_threads > 1)) {
+            return fail(ctx, MATMUL_ERR_MODE, "panel-packed modes only support the single-threaded block runner");
+        }
+    }
+
+    const char *isa = whole ? "generic" : isa_name(chosen);
+    if (whole == kernel_strassen_whole) {
+        StrassenConfig cfg = ctx->strassen;
+        if (ctx->strassen_leaf != "blas_whole") {
+            cfg.leaf = get_kernel_for_mode(ctx->strassen_leaf, &chosen);
+            if (!cfg.leaf || bs <= 0) {
+                return fail(ctx, MATMUL_ERR_ARG, "the strassen leaf must be blas_whole or a block mode (with a positive BS)");
+            }
+            if (is_streaming_kernel(cfg.leaf)) {
+                return fail(ctx, MATMUL_ERR_MODE, "strassen leaf %s would stream temporaries that are combined again",
+                            ctx->strassen_leaf.c_str());
+            }
+            cfg.leaf_bs = bs;
+            isa = isa_name(chosen);
+        }
+        ctx->strassen_run = cfg;
+    } else if (whole == kernel_morton_whole) {
+        MortonConfig cfg;
+        cfg.leaf = get_kernel_for_mode(ctx->morton_leaf, &chosen);
+        if (!cfg.leaf || bs <= 0) {
+            return fail(ctx, MATMUL_ERR_ARG, "the morton leaf must be a block mode (with a positive BS)");
+        }
+        // Each leaf call is one k-panel to the kernel, so a streaming leaf would evict every
+        // partial C tile product instead of only the last one
+        if (is_streaming_kernel(cfg.leaf)) {
+            return fail(ctx, MATMUL_ERR_MODE, "morton leaf %s would stream partial C tiles", ctx->morton_leaf.c_str());
+        }
+        cfg.leaf_bs = bs;
+        isa = isa_name(chosen);
+        ctx->morton_run = cfg;
+    }
+    ctx->block_kernel = block;
+    ctx->packed_kernel = packed;
+    ctx->whole_kernel = whole;
+    ctx->f32_kernel = f32;
+    ctx->bf16_kernel = bf16;
+    ctx->BS = bs;
+    ctx->isa = isa;
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+matmul_status matmul_set_schedule(matmul_ctx *ctx, const char *schedule) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (!schedule || !parse_tile_schedule(schedule, &ctx->schedule)) {
+        return fail(ctx, MATMUL_ERR_ARG, "unknown schedule '%s' (expected static or steal)",
+                    schedule ? schedule : "(null)");
+    }
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+const char *matmul_selected_isa(const matmul_ctx *ctx) { return ctx ? ctx->isa : nullptr; }
+
+static bool has_kernel(const matmul_ctx *ctx) {
+    return ctx->block_kernel || ctx->packed_kernel || ctx->whole_kernel || ctx->f32_kernel || ctx->bf16_kernel;
+}
+
+const char *matmul_selected_runner(const matmul_ctx *ctx) {
+    if (!ctx || !has_kernel(ctx)) return nullptr;
+    if (ctx->whole_kernel) return "whole";
+    if (ctx->packed_kernel) return "packed";
+    return ctx->runner.c_str();
+}
+
+// Only the multithreaded block runner distributes tiles
+static bool parallel_tiles(const matmul_ctx *ctx, int batch) {
+    return !ctx->whole_kernel && !ctx->packed_kernel && ctx->runner == "block" && batch == 1 && ctx->num_threads > 1;
+}
+
+// MC/KC/NC of the goto runner for this shape
+static matmul_status resolve_blocking(matmul_ctx *ctx, const GemmDims &d, GotoBlocking *blk) {
+    const GotoBlocking derived = goto_blocking_from_cache(ctx->l2_bytes, ctx->l3_bytes, d, ctx->BS);
+    *blk = ctx->blocking;
+    if (blk->MC <= 0) blk->MC = derived.MC;
+    if (blk->KC <= 0) blk->KC = derived.KC;
+    if (blk->NC <= 0) blk->NC = derived.NC;
+    if (blk->MC % ctx->BS != 0 || blk->KC % ctx->BS != 0 || blk->NC % ctx->BS != 0) {
+        return fail(ctx, MATMUL_ERR_ARG, "MC, KC and NC must be positive multiples of BS");
+    }
+    return MATMUL_OK;
+}
+
+// Checks that the selected kernel can run batch products of shape d
+static matmul_status check_call(matmul_ctx *ctx, const GemmDims &d, int batch, GotoBlocking *blk) {
+    if (!has_kernel(ctx)) return fail(ctx, MATMUL_ERR_NO_KERNEL, "no kernel selected");
+    if (batch > 1 && ctx->runner != "block") {
+        return fail(ctx, MATMUL_ERR_MODE, "batches only support the block runner");
+    }
+    if (batch > 1 && ctx->packed_kernel) {
+        return fail(ctx, MATMUL_ERR_MODE, "panel-packed modes only support the single-threaded block runner");
+    }
+    if (ctx->schedule != TileSchedule::static_split && !parallel_tiles(ctx, batch)) {
+        return fail(ctx, MATMUL_ERR_MODE, "schedule %s needs a block mode with more than one thread, "
+                    "the block runner and no batch", tile_schedule_name(ctx->schedule));
+    }
+    if (!ctx->whole_kernel && ctx->runner == "goto") return resolve_blocking(ctx, d, blk);
+    return MATMUL_OK;
+}
+
+static GemmDims make_dims(int M, int N, int K, int lda, int ldb, int ldc) {
+    GemmDims d;
+    d.M = M; d.N = N; d.K = K;
+    d.lda = lda; d.ldb = ldb; d.ldc = ldc;
+    return d;
+}
+
+matmul_status matmul_runner_blocking(matmul_ctx *ctx, int M, int N, int K, int *mc, int *kc, int *nc) {
+    if (!ctx || M <= 0 || N <= 0 || K <= 0) return MATMUL_ERR_ARG;
+    if (!ctx->block_kernel || ctx->runner != "goto") {
+        return fail(ctx, MATMUL_ERR_MODE, "only the goto runner has MC/KC/NC blocking");
+    }
+    GotoBlocking blk;
+    const matmul_status st = resolve_blocking(ctx, make_dims(M, N, K, K, N, N), &blk);
+    if (st != MATMUL_OK) return st;
+    if (mc) *mc = blk.MC;
+    if (kc) *kc = blk.KC;
+    if (nc) *nc = blk.NC;
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+// Grows the workspace the selected kernel needs for this shape (a no-op once it fits);
+// whole-matrix batches run one product per thread
+static bool reserve_workspace(matmul_ctx *ctx, const GemmDims &d, const GotoBlocking &blk) {
+    if (ctx->whole_kernel == kernel_strassen_whole) {
+        const StrassenConfig &cfg = ctx->strassen_run;
+        if (cfg.leaf && !pack_arena::reserve(size_t(cfg.leaf_bs) * cfg.leaf_bs, size_t(cfg.leaf_bs) * cfg.leaf_bs,
+                                             ctx->num_threads)) {
+            return false;
+        }
+        return strassen_reserve(cfg, d, ctx->num_threads);
+    }
+    if (ctx->whole_kernel == kernel_morton_whole) return morton_reserve(ctx->morton_run, d, ctx->num_threads);
+    if (ctx->whole_kernel) return true;
+    return reserve_pack_workspace(ctx->runner, d, ctx->BS, blk, ctx->packed_kernel ? 1 : ctx->num_threads) &&
+           (ctx->schedule != TileSchedule::steal || ctx->queues.reserve(ctx->num_threads));
+}
+
+matmul_status matmul_reserve(matmul_ctx *ctx, int M, int N, int K, int batch) {
+    if (!ctx || M <= 0 || N <= 0 || K <= 0 || batch <= 0) return MATMUL_ERR_ARG;
+    const GemmDims d = make_dims(M, N, K, K, N, N);
+    GotoBlocking blk;
+    const matmul_status st = check_call(ctx, d, batch, &blk);
+    if (st != MATMUL_OK) return st;
+    if (!reserve_workspace(ctx, d, blk)) return fail(ctx, MATMUL_ERR_ALLOC, "workspace allocation failed");
+    // Per-thread EventSets are created here, on the pool threads, not in a measured call
+    if (ctx->counters && ctx->num_threads > 1) papito_thread_prepare(ctx->num_threads);
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+// Serial, parallel or batched block runner (entries.size() > 1 is a batch), for any
+// element type; stats and queues only apply to the parallel runner
+template <typename T, typename P>
+static void run_block(std::vector<const T*> &as, std::vector<const T*> &bs, std::vector<T*> &cs,
+                      const matmul_gemm_desc &g, const GemmDims &d, int BS, matmul_kernel_t<T, P> kernel,
+                      int num_threads, TileSchedule schedule, SchedStats *stats, TileQueues *queues) {
+    const T *A = static_cast<const T*>(g.A), *B = static_cast<const T*>(g.B);
+    T *C = static_cast<T*>(g.C);
+    if (g.batch > 1) {
+        as.resize(g.batch);
+        bs.resize(g.batch);
+        cs.resize(g.batch);
+        for (int b = 0; b < g.batch; ++b) {
+            as[b] = A + b * g.stride_a;
+            bs[b] = B + b * g.stride_b;
+            cs[b] = C + b * g.stride_c;
+        }
+        run_benchmark_batched(as.data(), bs.data(), cs.data(), g.batch, d, BS, kernel, num_threads);
+    } else if (num_threads > 1) {
+        run_benchmark_parallel(A, B, C, d, BS, kernel, num_threads, schedule, stats, queues);
+    } else {
+        run_benchmark(A, B, C, d, BS, kernel);
+    }
+}
+
+// Zeroes the M x N part of every C entry (the block runners accumulate into C)
+template <typename T>
+static void clear_c(const matmul_gemm_desc &g) {
+    T *C = static_cast<T*>(g.C);
+    for (int b = 0; b < g.batch; ++b) {
+        for (int i = 0; i < g.M; ++i) memset(C + b * g.stride_c + size_t(i) * g.ldc, 0, sizeof(T) * g.N);
+    }
+}
+
+static void end_measurement(matmul_ctx *ctx) {
+    papito_end();
+    const PapitoResults &res = papito_last_results();
+    ctx->counter_names = res.event_names;
+    ctx->counter_values = res.values;
+}
+
+matmul_status matmul_gemm(matmul_ctx *ctx, const matmul_gemm_desc *desc) {
+    if (!ctx || !desc) return MATMUL_ERR_ARG;
+    const matmul_gemm_desc &g = *desc;
+    if (!g.A || !g.B || !g.C || g.M <= 0 || g.N <= 0 || g.K <= 0 || g.batch <= 0 ||
+        g.lda < g.K || g.ldb < g.N || g.ldc < g.N) {
+        return fail(ctx, MATMUL_ERR_ARG, "null operand, non-positive size or too small leading dimension");
+    }
+    if (g.batch > 1 && (g.stride_a < (long long)g.M * g.lda || g.stride_b < (long long)g.K * g.ldb ||
+                        g.stride_c < (long long)g.M * g.ldc)) {
+        return fail(ctx, MATMUL_ERR_ARG, "batch strides must not overlap the entries");
+    }
+    const GemmDims d = make_dims(g.M, g.N, g.K, g.lda, g.ldb, g.ldc);
+    GotoBlocking blk;
+    matmul_status st = check_call(ctx, d, g.batch, &blk);
+    if (st != MATMUL_OK) return st;
+    if (!reserve_workspace(ctx, d, blk)) return fail(ctx, MATMUL_ERR_ALLOC, "workspace allocation failed");
+
+    const bool low_precision = ctx->f32_kernel || ctx->bf16_kernel;
+    if (!ctx->whole_kernel && !(g.flags & MATMUL_C_ZEROED)) {
+        if (low_precision) clear_c<float>(g); else clear_c<double>(g);
+    }
+    SchedStats *sched = parallel_tiles(ctx, g.batch) ? &ctx->sched : nullptr;
+    const double *A = static_cast<const double*>(g.A), *B = static_cast<const double*>(g.B);
+    double *C = static_cast<double*>(g.C);
+
+    if (ctx->counters && !ctx->in_session) papito_start();
+    auto t0 = std::chrono::steady_clock::now();
+    WholeKernel whole;
+    whole.func = ctx->whole_kernel;
+    if (ctx->whole_kernel == kernel_strassen_whole) whole.strassen = &ctx->strassen_run;
+    if (ctx->whole_kernel == kernel_morton_whole) whole.morton = &ctx->morton_run;
+    papito_region_begin_id(REGION_GEMM);
+    if (ctx->whole_kernel && g.batch > 1) {
+        ctx->batch_a.resize(g.batch);
+        ctx->batch_b.resize(g.batch);
+        ctx->batch_c.resize(g.batch);
+        for (int b = 0; b < g.batch; ++b) {
+            ctx->batch_a[b] = A + b * g.stride_a;
+            ctx->batch_b[b] = B + b * g.stride_b;
+            ctx->batch_c[b] = C + b * g.stride_c;
+        }
+        run_benchmark_whole_batched(ctx->batch_a.data(), ctx->batch_b.data(), ctx->batch_c.data(), g.batch, d,
+                                    whole, ctx->num_threads);
+    } else if (ctx->whole_kernel) {
+        run_benchmark_whole_matrix(A, B, C, d, whole);
+    } else if (ctx->packed_kernel) {
+        run_benchmark_packed(A, B, C, d, ctx->BS, ctx->packed_kernel);
+    } else if (ctx->f32_kernel) {
+        run_block(ctx->batch_af, ctx->batch_bf, ctx->batch_cf, g, d, ctx->BS, ctx->f32_kernel,
+                  ctx->num_threads, ctx->schedule, sched, &ctx->queues);
+    } else if (ctx->bf16_kernel) {
+        run_block(ctx->batch_af, ctx->batch_bf, ctx->batch_cf, g, d, ctx->BS, ctx->bf16_kernel,
+                  ctx->num_threads, ctx->schedule, sched, &ctx->queues);
+    } else if (ctx->runner == "bpanel" || ctx->runner == "goto") {
+        RunnerPhaseTimes times;
+        if (ctx->runner == "bpanel") {
+            run_benchmark_bpanel(A, B, C, d, ctx->BS, ctx->block_kernel, &times);
+        } else {
+            run_benchmark_goto(A, B, C, d, ctx->BS, blk, ctx->block_kernel, &times);
+        }
+        ctx->phases.pack_seconds += times.pack_seconds;
+        ctx->phases.kernel_seconds += times.kernel_seconds;
+    } else {
+        run_block(ctx->batch_a, ctx->batch_b, ctx->batch_c, g, d, ctx->BS, ctx->block_kernel,
+                  ctx->num_threads, ctx->schedule, sched, &ctx->queues);
+    }
+    papito_region_end_id(REGION_GEMM);
+    ctx->last_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (sched) ctx->have_sched = true;
+    if (ctx->counters && !ctx->in_session) end_measurement(ctx);
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+matmul_status matmul_dgemm(matmul_ctx *ctx, int M, int N, int K,
+                           const double *A, int lda, const double *B, int ldb,
+                           double *C, int ldc) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (ctx->f32_kernel || ctx->bf16_kernel) return fail(ctx, MATMUL_ERR_MODE, "matmul_dgemm needs an f64 kernel");
+    matmul_gemm_desc g = {};
+    g.M = M; g.N = N; g.K = K;
+    g.A = A; g.lda = lda;
+    g.B = B; g.ldb = ldb;
+    g.C = C; g.ldc = ldc;
+    g.batch = 1;
+    return matmul_gemm(ctx, &g);
+}
+
+double matmul_last_seconds(const matmul_ctx *ctx) { return ctx ? ctx->last_seconds : 0.0; }
+
+matmul_status matmul_phase_seconds(const matmul_ctx *ctx, double *pack_s, double *kernel_s) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (!ctx->block_kernel || (ctx->runner != "bpanel" && ctx->runner != "goto")) return MATMUL_ERR_MODE;
+    if (pack_s) *pack_s = ctx->phases.pack_seconds;
+    if (kernel_s) *kernel_s = ctx->phases.kernel_seconds;
+    return MATMUL_OK;
+}
+
+matmul_status matmul_schedule_stats(const matmul_ctx *ctx, int *task_tiles, long *tasks, int *threads) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (!ctx->have_sched) return MATMUL_ERR_MODE;
+    if (task_tiles) *task_tiles = ctx->sched.task_tiles;
+    if (tasks) *tasks = ctx->sched.tasks;
+    if (threads) *threads = int(ctx->sched.threads.size());
+    return MATMUL_OK;
+}
+
+matmul_status matmul_schedule_thread(const matmul_ctx *ctx, int thread, double *busy_s, long *tiles, long *steals) {
+    if (!ctx || thread < 0) return MATMUL_ERR_ARG;
+    if (!ctx->have_sched) return MATMUL_ERR_MODE;
+    if (thread >= int(ctx->sched.threads.size())) return MATMUL_ERR_ARG;
+    const ThreadSchedStats &t = ctx->sched.threads[thread];
+    if (busy_s) *busy_s = t.busy_seconds;
+    if (tiles) *tiles = t.tiles;
+    if (steals) *steals = t.steals;
+    return MATMUL_OK;
+}
+
+void matmul_reset_stats(matmul_ctx *ctx) {
+    if (!ctx) return;
+    ctx->phases = RunnerPhaseTimes();
+    // The per-thread slots are kept, so the next parallel call does not allocate them again
+    for (ThreadSchedStats &t : ctx->sched.threads) t = ThreadSchedStats();
+    ctx->sched.task_tiles = 0;
+    ctx->sched.tasks = 0;
+    ctx->have_sched = false;
+}
+
+long matmul_workspace_growths(void) { return pack_arena::growths(); }
+
+matmul_status matmul_counters_begin(matmul_ctx *ctx) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (!ctx->counters) return fail(ctx, MATMUL_ERR_MODE, "context created without counters");
+    if (ctx->in_session) return fail(ctx, MATMUL_ERR_ARG, "counter session already open");
+    papito_start();
+    ctx->in_session = true;
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+matmul_status matmul_counters_end(matmul_ctx *ctx) {
+    if (!ctx) return MATMUL_ERR_ARG;
+    if (!ctx->in_session) return fail(ctx, MATMUL_ERR_ARG, "no counter session open");
+    end_measurement(ctx);
+    ctx->in_session = false;
+    ctx->error.clear();
+    return MATMUL_OK;
+}
+
+int matmul_counter_count(const matmul_ctx *ctx) { return ctx ? int(ctx->counter_values.size()) : 0; }
+
+const char *matmul_counter_name(const matmul_ctx *ctx, int i) {
+    if (!ctx || i < 0 || i >= int(ctx->counter_names.size())) return nullptr;
+    return ctx->counter_names[i].c_str();
+}
+
+long long matmul_counter_value(const matmul_ctx *ctx, int i) {
+    if (!ctx || i < 0 || i >= int(ctx->counter_values.size())) return 0;
+    return ctx->counter_values[i];
+}
@@ -0,0 +1,110 @@
+#include "matrix_io.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace matrix_io {
+
+static bool fail(std::string *error, const std::string &path, const std::string &why) {
+    if (error) *error = path + ": " + why;
+    return false;
+}
+
+bool map_matrix(const std::string &path, MappedMatrix *out, std::string *error) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail(error, path, strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        return fail(error, path, strerror(err));
+    }
+    const size_t length = size_t(st.st_size);
+
+    Header h;
+    if (length < sizeof(h) || pread(fd, &h, sizeof(h), 0) != ssize_t(sizeof(h))) {
+        close(fd);
+        return fail(error, path, "too short for a matrix header");
+    }
+    if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION) {
+        close(fd);
+        return fail(error, path, "not a version 1 matrix file");
+    }
+    if (h.dtype != uint32_t(Dtype::f64)) {
+        close(fd);
+        return fail(error, path, "unsupported dtype (only f64)");
+    }
+    if (h.layout != uint32_t(Layout::row_major)) {
+        close(fd);
+        return fail(error, path, "unsupported layout (only row-major)");
+    }
+    if (h.rows == 0 || h.cols == 0 || h.batch == 0 || h.rows * h.batch > uint64_t(INT32_MAX) ||
+        h.cols > uint64_t(INT32_MAX)) {
+        close(fd);
+        return fail(error, path, "invalid dimensions");
+    }
+    const uint64_t payload = h.rows * h.cols * h.batch * sizeof(double);
+    if (length != sizeof(h) + payload) {
+        close(fd);
+        return fail(error, path, "size does not match the header dimensions");
+    }
+
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) return fail(error, path, strerror(err));
+
+    out->base = base;
+    out->length = length;
+    out->data = reinterpret_cast<double*>(static_cast<char*>(base) + sizeof(Header));
+    out->rows = int(h.rows);
+    out->cols = int(h.cols);
+    out->batch = int(h.batch);
+    return true;
+}
+
+void unmap_matrix(MappedMatrix *m) {
+    if (m->base) munmap(m->base, m->length);
+    *m = MappedMatrix();
+}
+
+bool write_matrix(const std::string &path, const double *data, int rows, int cols, int batch,
+                  std::string *error) {
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.dtype = uint32_t(Dtype::f64);
+    h.layout = uint32_t(Layout::row_major);
+    h.batch = uint32_t(batch);
+    h.rows = uint64_t(rows);
+    h.cols = uint64_t(cols);
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return fail(error, path, strerror(errno));
+
+    // Header first, then the payload in 8 MiB writes
+    const char *chunks[2] = {reinterpret_cast<const char*>(&h), reinterpret_cast<const char*>(data)};
+    const size_t sizes[2] = {sizeof(h), size_t(rows) * size_t(cols) * size_t(batch) * sizeof(double)};
+    constexpr size_t CHUNK = size_t(8) << 20;
+    for (int part = 0; part < 2; ++part) {
+        for (size_t done = 0; done < sizes[part];) {
+            ssize_t n = write(fd, chunks[part] + done, std::min(CHUNK, sizes[part] - done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                int err = errno;
+                close(fd);
+                return fail(error, path, strerror(err));
+            }
+            done += size_t(n);
+        }
+    }
+    if (close(fd) != 0) return fail(error, path, strerror(errno));
+    return true;
+}
+
+} // namespace matrix_io
@@ -1,22 +1,217 @@
 #include "matrix_utils.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
 #include <cstdlib> // For posix_memalign and free
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <mutex>
 
 namespace matrix_utils {
 
 double* alloc(int N) {
+    return alloc(N, N);
+}
+
+double* alloc(int rows, int cols) {
     void* p = nullptr;
     // Align memory to a 64-byte boundary for AVX-512 compatibility
-    if (posix_memalign(&p, 64, sizeof(double) * size_t(N) * size_t(N)) != 0) {
+    if (posix_memalign(&p, 64, sizeof(double) * size_t(rows) * size_t(cols)) != 0) {
         return nullptr;
     }
     return static_cast<double*>(p);
 }
 
-void fill(double *matrix, int N) {
-    for (long i = 0; i < (long)N * N; ++i) {
-        // Simple pseudo-random filling
-        matrix[i] = static_cast<double>((i * 33 + 7) % 100) + 1.0;
+// mmap'ed (hugetlbfs) allocations and their mapped length, for release()
+static std::mutex mapped_mutex;
+static std::map<void*, size_t> mapped;
+
+constexpr size_t PAGE_4K = size_t(1) << 12;
+constexpr size_t PAGE_2M = size_t(1) << 21;
+constexpr size_t PAGE_1G = size_t(1) << 30;
+
+// fill() work unit (one 2 MiB page of doubles) and the checksum's pairwise block
+constexpr long CHUNK_ELEMS = long(1) << 18;
+constexpr size_t CHECKSUM_BLOCK = 4096;
+
+// From <linux/mempolicy.h>; called through syscall() so libnuma is not required
+constexpr int MPOL_INTERLEAVE_ = 3;
+constexpr int MPOL_LOCAL_ = 4;
+constexpr int MAP_HUGE_SHIFT_ = 26;
+
+static const char *const PAGE_POLICY_NAMES[] = {"aligned", "thp", "huge2m", "huge1g"};
+static const char *const NUMA_POLICY_NAMES[] = {"none", "local", "interleave"};
+
+bool parse_page_policy(const std::string &name, PagePolicy *out) {
+    for (int i = 0; i < 4; ++i) {
+        if (name == PAGE_POLICY_NAMES[i]) { *out = PagePolicy(i); return true; }
+    }
+    return false;
+}
+
+bool parse_numa_policy(const std::string &name, NumaPolicy *out) {
+    for (int i = 0; i < 3; ++i) {
+        if (name == NUMA_POLICY_NAMES[i]) { *out = NumaPolicy(i); return true; }
+    }
+    return false;
+}
+
+const char* page_policy_name(PagePolicy p) { return PAGE_POLICY_NAMES[int(p)]; }
+const char* numa_policy_name(NumaPolicy p) { return NUMA_POLICY_NAMES[int(p)]; }
+
+// Bitmask of the online NUMA nodes (from sysfs, e.g. "0-1" or "0,2"); node 0 if unknown
+static unsigned long online_nodes() {
+    unsigned long mask = 0;
+    char buf[256] = "";
+    FILE *f = fopen("/sys/devices/system/node/online", "r");
+    if (f) {
+        if (!fgets(buf, sizeof(buf), f)) buf[0] = '\0';
+        fclose(f);
+    }
+    for (char *s = buf, *end; ; s = end + 1) {
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s) break;
+        if (*end == '-') hi = strtol(end + 1, &end, 10);
+        for (long n = lo; n <= hi && n < long(8 * sizeof(mask)); ++n) mask |= 1UL << n;
+        if (*end != ',') break;
+    }
+    return mask ? mask : 1UL;
+}
+
+static void apply_numa_policy(void *p, size_t bytes, NumaPolicy numa) {
+    if (numa == NumaPolicy::none) return;
+    unsigned long mask = online_nodes();
+    long ret = numa == NumaPolicy::interleave
+        ? syscall(SYS_mbind, p, bytes, MPOL_INTERLEAVE_, &mask, 8 * sizeof(mask) + 1, 0)
+        : syscall(SYS_mbind, p, bytes, MPOL_LOCAL_, nullptr, 0, 0);
+    if (ret != 0) perror("Warning: mbind failed; keeping the default NUMA placement");
+}
+
+static void *map_hugetlb(size_t bytes, size_t page, int log2_page) {
+    size_t len = (bytes + page - 1) / page * page;
+    void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2_page << MAP_HUGE_SHIFT_), -1, 0);
+    if (p == MAP_FAILED) return nullptr;
+    std::lock_guard<std::mutex> lock(mapped_mutex);
+    mapped[p] = len;
+    return p;
+}
+
+double* alloc_matrix(size_t rows, int cols, PagePolicy pages, NumaPolicy numa, int num_threads,
+                     PagePolicy *granted, bool zero) {
+    const size_t elems = rows * size_t(cols);
+    const size_t bytes = sizeof(double) * elems;
+    void *p = nullptr;
+
+    if (pages == PagePolicy::huge2m) p = map_hugetlb(bytes, PAGE_2M, 21);
+    if (pages == PagePolicy::huge1g) p = map_hugetlb(bytes, PAGE_1G, 30);
+    if (!p && pages != PagePolicy::aligned) {
+        // Empty hugetlbfs pool: transparent huge pages are the closest fallback
+        pages = PagePolicy::thp;
+        size_t len = (bytes + PAGE_2M - 1) / PAGE_2M * PAGE_2M;
+        if (posix_memalign(&p, PAGE_2M, len) != 0) return nullptr;
+        madvise(p, len, MADV_HUGEPAGE);
+    }
+    if (!p) {
+        // mbind works on whole pages
+        if (posix_memalign(&p, numa == NumaPolicy::none ? 64 : PAGE_4K, bytes) != 0) return nullptr;
     }
+    if (granted) *granted = pages;
+
+    apply_numa_policy(p, bytes, numa);
+
+    // First touch: with the static schedule each thread faults in the rows it will own
+    double *m = static_cast<double*>(p);
+    if (!zero) return m;
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (long i = 0; i < long(elems); ++i) m[i] = 0.0;
+    return m;
+}
+
+void release(double *p) {
+    if (!p) return;
+    {
+        std::lock_guard<std::mutex> lock(mapped_mutex);
+        auto it = mapped.find(p);
+        if (it != mapped.end()) {
+            munmap(p, it->second);
+            mapped.erase(it);
+            return;
+        }
+    }
+    free(p);
+}
+
+// lowbias32 (C. Wellons): a bijective 32-bit mixer with full avalanche
+static inline uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Elements [begin, begin + n) of one 2^32-element span, whose key folds in the span index.
+// Only 32-bit lanes are used, so the multiplies vectorise on every x86 tier.
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static void fill_span(double *out, uint32_t begin, uint32_t n, uint32_t key) {
+    #pragma omp simd
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t h = mix32((begin + i) ^ key);
+        // Lemire's multiply-shift maps h onto [0, 100) without a division
+        out[i] = double(int32_t((uint64_t(h) * 100u) >> 32) + 1);
+    }
+}
+
+void fill(double *matrix, size_t count, uint32_t seed, uint32_t stream, int num_threads) {
+    const uint32_t key = mix32(seed ^ mix32(stream + 0x9e3779b9u));
+    #pragma omp parallel num_threads(num_threads)
+    {
+        // Contiguous static ranges per thread, as in alloc_matrix's first touch
+        #pragma omp for schedule(static)
+        for (long t = 0; t < long(count); t += CHUNK_ELEMS) {
+            const size_t n = std::min(size_t(CHUNK_ELEMS), count - size_t(t));
+            const size_t start = size_t(t);
+            const uint32_t span_key = key ^ mix32(uint32_t(start >> 32));
+            fill_span(matrix + start, uint32_t(start), uint32_t(n), span_key);
+        }
+    }
+}
+
+// Pairwise sum of one block; the leaves are short enough for a plain vector reduction
+template <typename T>
+static double pairwise(const T *v, size_t n) {
+    if (n <= 64) {
+        double s = 0.0;
+        #pragma omp simd reduction(+ : s)
+        for (size_t i = 0; i < n; ++i) s += double(v[i]);
+        return s;
+    }
+    const size_t half = n / 2;
+    return pairwise(v, half) + pairwise(v + half, n - half);
+}
+
+template <typename T>
+static double checksum_t(const T *values, size_t count, int num_threads) {
+    const size_t blocks = (count + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK;
+    std::vector<double> partial(blocks);
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (long b = 0; b < long(blocks); ++b) {
+        const size_t begin = size_t(b) * CHECKSUM_BLOCK;
+        partial[b] = pairwise(values + begin, std::min(CHECKSUM_BLOCK, count - begin));
+    }
+    return blocks ? pairwise(partial.data(), blocks) : 0.0;
+}
+
+double checksum(const double *values, size_t count, int num_threads) {
+    return checksum_t(values, count, num_threads);
+}
+
+double checksum(const float *values, size_t count, int num_threads) {
+    return checksum_t(values, count, num_threads);
 }
 
 } // namespace matrix_utils
@@ -0,0 +1,57 @@
+#include "pack_arena.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace pack_arena {
+
+static std::atomic<long> growth_count{0};
+
+struct Buffer {
+    double *p = nullptr;
+    size_t capacity = 0;
+
+    ~Buffer() { free(p); }
+
+    bool grow(size_t elems) {
+        if (elems <= capacity) return true;
+        void *v = nullptr;
+        if (posix_memalign(&v, 64, sizeof(double) * elems) != 0) return false;
+        double *q = static_cast<double*>(v);
+        memset(q, 0, sizeof(double) * elems); // prefault now rather than inside the kernel
+        free(p);
+        p = q;
+        capacity = elems;
+        growth_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+struct Workspace {
+    Buffer a, b;
+};
+
+static thread_local Workspace workspace;
+
+bool acquire(size_t a_elems, size_t b_elems, double **a, double **b) {
+    if (!workspace.a.grow(a_elems) || !workspace.b.grow(b_elems)) return false;
+    *a = workspace.a.p;
+    *b = workspace.b.p;
+    return true;
+}
+
+bool reserve(size_t a_elems, size_t b_elems, int num_threads) {
+    bool ok = true;
+    #pragma omp parallel num_threads(num_threads) reduction(&& : ok)
+    {
+        double *a, *b;
+        ok = acquire(a_elems, b_elems, &a, &b);
+    }
+    return ok;
+}
+
+long growths() {
+    return growth_count.load(std::memory_order_relaxed);
+}
+
+} // namespace pack_arena
@@ -11,6 +11,11 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <unistd.h>
+#include <map>
+#include <mutex>
+#include <omp.h>
+#include <pthread.h>
 
 static int EventSet = PAPI_NULL;
 static std::vector<int> event_codes;
@@ -22,12 +27,64 @@ static bool multiplex_init_ok = false;
 
 static const char* DEFAULT_COUNTERS_FILE = "counters.in";
 
+// Estado das regiões nomeadas (papito_region_begin/end). Tudo que o caminho quente toca tem
+// tamanho fixo: a pilha guarda ids e buffers de início, e os totais são indexados pelo id do
+// caminho, criado (com a única concatenação de strings) só na primeira entrada após papito_start.
+constexpr int REGION_MAX_EVENTS = 32;
+constexpr int REGION_MAX_DEPTH = 8;
+struct RegionFrame {
+    int name = -1;
+    int path = -1;
+    long long start[REGION_MAX_EVENTS];
+};
+struct RegionPath {
+    std::string path;            // ex.: "gemm/pack_B"
+    int parent = -1, name = -1;
+    long long entries = 0;
+    long long values[REGION_MAX_EVENTS] = {};
+};
+static bool regions_enabled = false;
+static RegionFrame region_stack[REGION_MAX_DEPTH];
+static int region_depth = 0;
+static int region_overflow = 0;               // begins ignorados além de REGION_MAX_DEPTH
+static std::vector<RegionPath> region_paths;  // ordem da primeira entrada
+static bool region_mismatch_warned = false;
+
+// Nomes registrados por papito_region_id; nunca são apagados, então os ids valem o processo
+// todo (estático local: os runners registram os seus na inicialização estática)
+static std::vector<std::string>& region_names() {
+    static std::vector<std::string> names;
+    return names;
+}
+
+// Estado por thread (papito_thread_begin/end)
+struct ThreadTotals {
+    long long entries = 0;
+    std::vector<long long> values;
+};
+static std::mutex thread_mutex;
+static std::map<int, ThreadTotals> thread_totals;
+static pthread_t main_thread;
+// O EventSet de cada thread trabalhadora é criado uma vez (papito_thread_prepare, ou na primeira
+// região) e fica contando até papito_finalize; begin/end só fazem PAPI_read
+static thread_local int thread_eventset = PAPI_NULL;
+static thread_local bool thread_eventset_failed = false;
+static thread_local bool thread_active = false;
+static thread_local bool thread_is_main = false;
+static thread_local long long thread_start[REGION_MAX_EVENTS];
+static int thread_team_max = 0;                // maior equipe vista, para o teardown
+
+static std::vector<std::string> dropped_events; // nomes de counters.in que ficaram de fora
+static PapitoResults last_results;
+
 static void die_with_msg(const std::string &s) {
     std::cerr << "[papito][FATAL] " << s << std::endl;
     std::exit(1);
 }
-static void warn_msg(const std::string &s) { std::cerr << "[papito][WARN] " << s << std::endl; }
-static void info_msg(const std::string &s) { std::cerr << "[papito][INFO] " << s << std::endl; }
+static bool quiet = false;                     // papito_set_quiet
+static std::ostream null_out(nullptr);         // descarta tudo (sem streambuf)
+static void warn_msg(const std::string &s) { if (!quiet) std::cerr << "[papito][WARN] " << s << std::endl; }
+static void info_msg(const std::string &s) { if (!quiet) std::cerr << "[papito][INFO] " << s << std::endl; }
 
 static std::string trim(const std::string &s) {
     size_t a = s.find_first_not_of(" \t\r\n");
@@ -57,6 +114,31 @@ static int get_num_counters_fallback() {
     return PAPI_num_hwctrs();
 }
 
+// Fills sizes[0..2] with the L1 data, L2 and L3 cache sizes in bytes (0 = unknown).
+// PAPI's memory hierarchy is used first; sysconf fills any level PAPI did not report.
+static void query_cache_sizes(long sizes[3]) {
+    sizes[0] = sizes[1] = sizes[2] = 0;
+    const PAPI_hw_info_t *hw = PAPI_get_hardware_info();
+    if (hw) {
+        const PAPI_mh_info_t &mh = hw->mem_hierarchy;
+        for (int lvl = 0; lvl < mh.levels && lvl < 3; ++lvl) {
+            for (int c = 0; c < PAPI_MH_MAX_LEVELS; ++c) {
+                int type = PAPI_MH_CACHE_TYPE(mh.level[lvl].cache[c].type);
+                if (type == PAPI_MH_TYPE_DATA || type == PAPI_MH_TYPE_UNIFIED) {
+                    sizes[lvl] = mh.level[lvl].cache[c].size;
+                    break;
+                }
+            }
+        }
+    }
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    if (sizes[0] <= 0) sizes[0] = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (sizes[1] <= 0) sizes[1] = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (sizes[2] <= 0) sizes[2] = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    for (int i = 0; i < 3; ++i) if (sizes[i] < 0) sizes[i] = 0;
+}
+
 static void show_papi_info() {
     const PAPI_hw_info_t *hw = PAPI_get_hardware_info();
     if (hw) {
@@ -69,14 +151,20 @@ static void show_papi_info() {
 
     int hwcnt = get_num_counters_fallback();
     info_msg(std::string("Hardware counters available: ") + std::to_string(hwcnt));
+
+    long caches[3];
+    query_cache_sizes(caches);
+    info_msg("Cache sizes (bytes): L1d=" + std::to_string(caches[0]) + " L2=" + std::to_string(caches[1])
+             + " L3=" + std::to_string(caches[2]));
 }
 
 // Substituir a implementação anterior por esta:
-static void prepare_eventset_from_file(const std::string &path) {
+// Retorna PAPI_OK ou o erro de PAPI_create_eventset (eventos indisponíveis só geram avisos)
+static int prepare_eventset_from_file(const std::string &path) {
     auto lines = read_counters_file(path);
     if (lines.empty()) {
         warn_msg("No events read from file '" + path + "'. No events will be measured.");
-        return;
+        return PAPI_OK;
     }
 
     int num_hw_counters = get_num_counters_fallback();
@@ -84,7 +172,9 @@ static void prepare_eventset_from_file(const std::string &path) {
 
     int ret = PAPI_create_eventset(&EventSet);
     if (ret != PAPI_OK) {
-        die_with_msg(std::string("PAPI_create_eventset failed: ") + PAPI_strerror(ret));
+        warn_msg(std::string("PAPI_create_eventset failed: ") + PAPI_strerror(ret));
+        EventSet = PAPI_NULL;
+        return ret;
     }
 
     // We'll add the first event first (so PAPI can set the component for the eventset).
@@ -193,26 +283,42 @@ static void prepare_eventset_from_file(const std::string &path) {
         }
     } // end for
 
+    for (const auto &ename : lines) {
+        if (std::find(event_names.begin(), event_names.end(), ename) == event_names.end()) {
+            dropped_events.push_back(ename);
+        }
+    }
+
     if (event_codes.empty()) {
         warn_msg("No events successfully added to EventSet. PAPI will run but not measure counters.");
     } else {
         info_msg("Total events added: " + std::to_string(event_codes.size()));
         info_msg(std::string("Multiplexing: ") + (used_multiplex ? "ON" : "OFF"));
     }
+    return PAPI_OK;
 }
 
 
-void papito_init() {
-    if (papito_inited) return;
+int papito_try_init() {
+    if (papito_inited) return PAPITO_OK;
 
     int retval = PAPI_library_init(PAPI_VER_CURRENT);
     if (retval != PAPI_VER_CURRENT && retval > 0) {
-        die_with_msg("PAPI_library_init version mismatch");
+        warn_msg("PAPI_library_init version mismatch");
+        return PAPITO_ERR_VERSION;
     } else if (retval < 0) {
-        die_with_msg("PAPI_library_init failed");
+        warn_msg(std::string("PAPI_library_init failed: ") + PAPI_strerror(retval));
+        return PAPITO_ERR_INIT;
     }
     info_msg("PAPI initialized.");
 
+    // Necessário antes de qualquer EventSet para que as threads OpenMP possam ter os seus
+    retval = PAPI_thread_init(reinterpret_cast<unsigned long (*)(void)>(pthread_self));
+    if (retval != PAPI_OK) {
+        warn_msg(std::string("PAPI_thread_init failed: ") + PAPI_strerror(retval) + ". Per-thread counters unavailable.");
+    }
+    main_thread = pthread_self();
+
     // show build/version info
     show_papi_info();
 
@@ -232,9 +338,34 @@ void papito_init() {
     std::string counters_file = envp ? std::string(envp) : std::string(DEFAULT_COUNTERS_FILE);
     info_msg("Reading counters from: " + counters_file);
 
-    prepare_eventset_from_file(counters_file);
+    if (prepare_eventset_from_file(counters_file) != PAPI_OK) {
+        // Desfaz o PAPI_library_init para que uma nova tentativa comece do zero
+        event_codes.clear();
+        event_names.clear();
+        dropped_events.clear();
+        used_multiplex = false;
+        PAPI_shutdown();
+        return PAPITO_ERR_EVENTSET;
+    }
+
+    const char* regions_env = std::getenv("PAPITO_REGIONS");
+    regions_enabled = regions_env && std::strcmp(regions_env, "1") == 0;
+    if (regions_enabled && event_codes.size() > size_t(REGION_MAX_EVENTS)) {
+        warn_msg("More than " + std::to_string(REGION_MAX_EVENTS) + " events; regions disabled.");
+        regions_enabled = false;
+    }
 
     papito_inited = true;
+    return PAPITO_OK;
+}
+
+void papito_init() {
+    switch (papito_try_init()) {
+    case PAPITO_OK: break;
+    case PAPITO_ERR_VERSION: die_with_msg("PAPI_library_init version mismatch"); break;
+    case PAPITO_ERR_INIT: die_with_msg("PAPI_library_init failed"); break;
+    default: die_with_msg("PAPI_create_eventset failed"); break;
+    }
 }
 
 void papito_start() {
@@ -247,6 +378,11 @@ void papito_start() {
         return;
     }
 
+    region_depth = 0;
+    region_overflow = 0;
+    region_paths.clear();
+    thread_totals.clear();
+
     int ret = PAPI_start(EventSet);
     if (ret != PAPI_OK) {
         warn_msg(std::string("PAPI_start failed: ") + PAPI_strerror(ret));
@@ -261,6 +397,10 @@ void papito_end() {
         return;
     }
 
+    last_results = PapitoResults();
+    last_results.dropped = dropped_events;
+    last_results.multiplexed = used_multiplex;
+
     if (event_codes.empty()) {
         info_msg("No counters configured; papito_end returning without output.");
         papito_running = false;
@@ -280,19 +420,263 @@ void papito_end() {
     }
 
     // *** FIX: Print to stderr to avoid interfering with stdout data ***
-    std::cerr << "PAPITO_COUNTERS";
-    for (const auto& name : event_names) std::cerr << "\t" << name;
-    std::cerr << std::endl;
+    std::ostream &out = quiet ? null_out : std::cerr;
+    out << "PAPITO_COUNTERS";
+    for (const auto& name : event_names) out << "\t" << name;
+    out << std::endl;
+
+    out << "PAPITO_VALUES";
+    for (size_t i = 0; i < values.size(); ++i) out << "\t" << values[i];
+    out << std::endl;
+
+    if (region_depth + region_overflow > 0) {
+        warn_msg("papito_end called with " + std::to_string(region_depth + region_overflow) + " open region(s); they are dropped.");
+        region_depth = 0;
+        region_overflow = 0;
+    }
+    last_results.event_names = event_names;
+    last_results.values = values;
+    for (const RegionPath &rp : region_paths) {
+        PapitoRegionResult r;
+        r.path = rp.path;
+        r.entries = rp.entries;
+        r.values.assign(rp.values, rp.values + event_codes.size());
+        last_results.regions.push_back(r);
+    }
 
-    std::cerr << "PAPITO_VALUES";
-    for (size_t i = 0; i < values.size(); ++i) std::cerr << "\t" << values[i];
-    std::cerr << std::endl;
+    for (const auto &kv : thread_totals) {
+        PapitoThreadResult t;
+        t.thread = kv.first;
+        t.entries = kv.second.entries;
+        t.values = kv.second.values;
+        last_results.threads.push_back(t);
+    }
+    if (!thread_totals.empty()) {
+        std::vector<long long> total(event_codes.size(), 0LL), peak(event_codes.size(), 0LL);
+        out << "PAPITO_THREAD_COUNTERS\tthread\tentries";
+        for (const auto& name : event_names) out << "\t" << name;
+        out << std::endl;
+        for (const auto &t : last_results.threads) {
+            out << "PAPITO_THREAD\t" << t.thread << "\t" << t.entries;
+            for (size_t i = 0; i < t.values.size(); ++i) {
+                out << "\t" << t.values[i];
+                total[i] += t.values[i];
+                peak[i] = std::max(peak[i], t.values[i]);
+            }
+            out << std::endl;
+        }
+        out << "PAPITO_THREAD_TOTAL";
+        for (long long v : total) out << "\t" << v;
+        out << std::endl;
+        // max/média por evento: 1.0 = carga perfeitamente balanceada
+        const double nthreads = double(last_results.threads.size());
+        out << "PAPITO_THREAD_IMBALANCE";
+        for (size_t i = 0; i < total.size(); ++i) {
+            double mean = double(total[i]) / nthreads;
+            out << "\t" << (mean > 0.0 ? double(peak[i]) / mean : 0.0);
+        }
+        out << std::endl;
+    }
+
+    if (!last_results.regions.empty()) {
+        out << "PAPITO_REGION_COUNTERS\tregion\tentries";
+        for (const auto& name : event_names) out << "\t" << name;
+        out << std::endl;
+        for (const auto& r : last_results.regions) {
+            out << "PAPITO_REGION\t" << r.path << "\t" << r.entries;
+            for (long long v : r.values) out << "\t" << v;
+            out << std::endl;
+        }
+    }
 
     papito_running = false;
 }
 
+const PapitoResults& papito_last_results() {
+    return last_results;
+}
+
+static bool regions_active() {
+    return regions_enabled && papito_running && !event_codes.empty() && !omp_in_parallel();
+}
+
+int papito_region_id(const char *name) {
+    std::vector<std::string> &names = region_names();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return int(i);
+    }
+    names.push_back(name);
+    return int(names.size()) - 1;
+}
+
+// Caminho do filho name sob parent (-1 = raiz), criado na primeira entrada
+static int region_path(int parent, int name) {
+    for (size_t i = 0; i < region_paths.size(); ++i) {
+        if (region_paths[i].parent == parent && region_paths[i].name == name) return int(i);
+    }
+    RegionPath rp;
+    rp.parent = parent;
+    rp.name = name;
+    rp.path = (parent < 0 ? std::string() : region_paths[parent].path + "/") + region_names()[name];
+    region_paths.push_back(rp);
+    return int(region_paths.size()) - 1;
+}
+
+void papito_region_begin_id(int id) {
+    if (!regions_active()) return;
+    if (region_depth == REGION_MAX_DEPTH) {
+        ++region_overflow;
+        return;
+    }
+    RegionFrame &frame = region_stack[region_depth];
+    if (PAPI_read(EventSet, frame.start) != PAPI_OK) return;
+    frame.name = id;
+    frame.path = region_path(region_depth > 0 ? region_stack[region_depth - 1].path : -1, id);
+    ++region_depth;
+}
+
+void papito_region_end_id(int id) {
+    if (!regions_active()) return;
+    if (region_overflow > 0) {
+        --region_overflow;
+        return;
+    }
+    if (region_depth == 0 || region_stack[region_depth - 1].name != id) {
+        if (!region_mismatch_warned) {
+            const std::vector<std::string> &names = region_names();
+            warn_msg(std::string("papito_region_end(\"") + (id >= 0 && id < int(names.size()) ? names[id] : "?")
+                     + "\") does not match the innermost open region; ignored.");
+            region_mismatch_warned = true;
+        }
+        return;
+    }
+    long long now[REGION_MAX_EVENTS];
+    if (PAPI_read(EventSet, now) != PAPI_OK) return;
+
+    const RegionFrame &frame = region_stack[--region_depth];
+    RegionPath &rp = region_paths[frame.path];
+    for (size_t i = 0; i < event_codes.size(); ++i) rp.values[i] += now[i] - frame.start[i];
+    rp.entries++;
+}
+
+void papito_region_begin(const char *name) {
+    if (regions_active()) papito_region_begin_id(papito_region_id(name));
+}
+
+void papito_region_end(const char *name) {
+    if (regions_active()) papito_region_end_id(papito_region_id(name));
+}
+
+// Cria e inicia o EventSet da thread atual com os mesmos eventos do EventSet global
+static bool start_thread_eventset() {
+    if (PAPI_register_thread() != PAPI_OK) return false;
+    if (PAPI_create_eventset(&thread_eventset) != PAPI_OK) {
+        PAPI_unregister_thread();
+        thread_eventset = PAPI_NULL;
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < event_codes.size() && ok; ++i) {
+        ok = PAPI_add_event(thread_eventset, event_codes[i]) == PAPI_OK;
+        if (ok && i == 0 && used_multiplex) ok = PAPI_set_multiplex(thread_eventset) == PAPI_OK;
+    }
+    if (ok) ok = PAPI_start(thread_eventset) == PAPI_OK;
+    if (!ok) {
+        PAPI_cleanup_eventset(thread_eventset);
+        PAPI_destroy_eventset(&thread_eventset);
+        thread_eventset = PAPI_NULL;
+        PAPI_unregister_thread();
+    }
+    return ok;
+}
+
+// Garante o EventSet da thread trabalhadora atual; uma falha não é tentada de novo
+static bool ensure_thread_eventset() {
+    if (thread_eventset != PAPI_NULL) return true;
+    if (thread_eventset_failed) return false;
+    if (!start_thread_eventset()) {
+        thread_eventset_failed = true;
+        std::lock_guard<std::mutex> lock(thread_mutex);
+        warn_msg("Could not start a per-thread EventSet for OpenMP thread " + std::to_string(omp_get_thread_num()) + ".");
+        return false;
+    }
+    return true;
+}
+
+static void note_team_size() {
+    const int n = omp_get_num_threads();
+    std::lock_guard<std::mutex> lock(thread_mutex);
+    thread_team_max = std::max(thread_team_max, n);
+}
+
+void papito_thread_prepare(int num_threads) {
+    if (!papito_inited) papito_init();
+    if (event_codes.empty() || event_codes.size() > size_t(REGION_MAX_EVENTS) || num_threads <= 1) return;
+    #pragma omp parallel num_threads(num_threads)
+    {
+        if (!pthread_equal(pthread_self(), main_thread)) ensure_thread_eventset();
+        note_team_size();
+    }
+}
+
+void papito_thread_begin() {
+    if (!papito_running || event_codes.empty() || event_codes.size() > size_t(REGION_MAX_EVENTS) || thread_active) return;
+    thread_is_main = pthread_equal(pthread_self(), main_thread);
+    if (thread_is_main) {
+        // O EventSet global já está contando nesta thread: mede por diferença
+        if (PAPI_read(EventSet, thread_start) != PAPI_OK) return;
+    } else {
+        if (thread_eventset == PAPI_NULL && !thread_eventset_failed) note_team_size();
+        if (!ensure_thread_eventset() || PAPI_read(thread_eventset, thread_start) != PAPI_OK) return;
+    }
+    thread_active = true;
+}
+
+void papito_thread_end() {
+    if (!thread_active) return;
+    thread_active = false;
+
+    long long values[REGION_MAX_EVENTS];
+    if (PAPI_read(thread_is_main ? EventSet : thread_eventset, values) != PAPI_OK) return;
+    for (size_t i = 0; i < event_codes.size(); ++i) values[i] -= thread_start[i];
+
+    std::lock_guard<std::mutex> lock(thread_mutex);
+    ThreadTotals &t = thread_totals[omp_get_thread_num()];
+    if (t.values.empty()) t.values.assign(event_codes.size(), 0LL);
+    for (size_t i = 0; i < event_codes.size(); ++i) t.values[i] += values[i];
+    t.entries++;
+}
+
+void papito_cache_sizes(long *l1d, long *l2, long *l3) {
+    // Sem PAPI, sysconf ainda informa os tamanhos
+    if (!papito_inited) papito_try_init();
+    long caches[3];
+    query_cache_sizes(caches);
+    if (l1d) *l1d = caches[0];
+    if (l2) *l2 = caches[1];
+    if (l3) *l3 = caches[2];
+}
+
+void papito_set_quiet(int q) { quiet = q != 0; }
+
 void papito_finalize() {
     if (!papito_inited) return;
+    // Cada EventSet por thread só pode ser parado pela sua thread: uma equipe do maior tamanho
+    // usado reencontra as mesmas threads do pool do OpenMP
+    if (thread_team_max > 1) {
+        #pragma omp parallel num_threads(thread_team_max)
+        {
+            if (thread_eventset != PAPI_NULL) {
+                long long discard[REGION_MAX_EVENTS];
+                PAPI_stop(thread_eventset, discard);
+                PAPI_cleanup_eventset(thread_eventset);
+                PAPI_destroy_eventset(&thread_eventset);
+                thread_eventset = PAPI_NULL;
+                PAPI_unregister_thread();
+            }
+        }
+        thread_team_max = 0;
+    }
     if (EventSet != PAPI_NULL) {
         PAPI_cleanup_eventset(EventSet);
         PAPI_destroy_eventset(&EventSet);
@@ -0,0 +1,91 @@
+#include "roofline.h"
+#include <algorithm>
+#include <cmath>
+
+// Machine model: the defaults describe one core of a typical AVX-512 server part
+#ifndef ROOFLINE_FMA_UNITS
+#define ROOFLINE_FMA_UNITS 2           // FMA pipes per core
+#endif
+#ifndef ROOFLINE_L2_BYTES_PER_CYCLE
+#define ROOFLINE_L2_BYTES_PER_CYCLE 64 // L2 -> L1 fill bandwidth per core
+#endif
+#ifndef ROOFLINE_DRAM_GBS
+#define ROOFLINE_DRAM_GBS 20.0         // sustained memory bandwidth, shared by all threads
+#endif
+#ifndef ROOFLINE_GHZ
+#define ROOFLINE_GHZ 3.0               // clock used when PAPI_TOT_CYC was not measured
+#endif
+
+constexpr double CACHE_LINE_BYTES = 64.0;
+
+// Event total over all threads (threads are only reported for parallel regions), or NaN
+static double event_total(const PapitoResults &papi, const char *name) {
+    for (size_t i = 0; i < papi.event_names.size(); ++i) {
+        if (papi.event_names[i] != name) continue;
+        if (papi.threads.empty()) return double(papi.values[i]);
+        double sum = 0.0;
+        for (const PapitoThreadResult &t : papi.threads) {
+            if (i < t.values.size()) sum += double(t.values[i]);
+        }
+        return sum;
+    }
+    return NAN;
+}
+
+static int doubles_per_vector(IsaLevel isa) {
+    switch (isa) {
+        case IsaLevel::avx512_bf16:
+        case IsaLevel::avx512: return 8;
+        case IsaLevel::avx2: return 4;
+        default: return 1;
+    }
+}
+
+// FLOPs of one vector FMA lane relative to a double lane: vdpbf16ps does two multiply-adds
+// per float lane, so only the avx512_bf16 tier gains the 4x
+static int lane_scale(Dtype dtype, IsaLevel isa) {
+    if (isa == IsaLevel::scalar) return 1;
+    if (dtype == Dtype::bf16) return isa == IsaLevel::avx512_bf16 ? 4 : 2;
+    return dtype == Dtype::f32 ? 2 : 1;
+}
+
+RooflineResult compute_roofline(const GemmDims &d, int batch, int threads, int repeats, IsaLevel isa,
+                                double flops, double seconds, const PapitoResults &papi, Dtype dtype) {
+    RooflineResult r;
+    const double reps = double(std::max(repeats, 1));
+    const double cores = double(std::max(threads, 1));
+    r.gflops = seconds > 0.0 ? flops / seconds * 1e-9 : 0.0;
+
+    const double cycles = event_total(papi, "PAPI_TOT_CYC") / reps;
+    r.ghz = (std::isfinite(cycles) && cycles > 0.0 && seconds > 0.0) ? cycles / cores / seconds * 1e-9 : ROOFLINE_GHZ;
+    r.flops_per_cycle = r.ghz > 0.0 ? r.gflops / r.ghz / cores : 0.0;
+    r.peak_flops_per_cycle = 2.0 * ROOFLINE_FMA_UNITS * doubles_per_vector(isa) * lane_scale(dtype, isa);
+    r.peak_gflops = r.peak_flops_per_cycle * r.ghz * cores;
+    r.peak_share = r.peak_gflops > 0.0 ? r.gflops / r.peak_gflops : 0.0;
+
+    r.l2_bytes = event_total(papi, "PAPI_L1_DCM") / reps * CACHE_LINE_BYTES;
+    r.dram_bytes = event_total(papi, "PAPI_L2_DCM") / reps * CACHE_LINE_BYTES;
+    r.dram_from_counters = std::isfinite(r.dram_bytes);
+    if (!r.dram_from_counters) {
+        // Lower bound: read A and B once, read and write C once
+        const double elems = double(d.M) * d.K + double(d.K) * d.N + 2.0 * double(d.M) * d.N;
+        // the reduced-precision operands live in memory as float (bf16 exists only packed)
+        r.dram_bytes = elems * (dtype == Dtype::f64 ? sizeof(double) : sizeof(float)) * batch;
+    }
+    r.ai_l2 = r.l2_bytes > 0.0 ? flops / r.l2_bytes : NAN;
+    r.ai_dram = r.dram_bytes > 0.0 ? flops / r.dram_bytes : NAN;
+
+    // The lowest roof is the bottleneck; a cache level without data cannot bind
+    r.l2_roof_gflops = r.ai_l2 * ROOFLINE_L2_BYTES_PER_CYCLE * r.ghz * cores;
+    r.dram_roof_gflops = r.ai_dram * ROOFLINE_DRAM_GBS;
+    double roof = r.peak_gflops;
+    r.bound = "compute";
+    if (std::isfinite(r.l2_roof_gflops) && r.l2_roof_gflops < roof) {
+        roof = r.l2_roof_gflops;
+        r.bound = "l2";
+    }
+    if (std::isfinite(r.dram_roof_gflops) && r.dram_roof_gflops < roof) {
+        r.bound = "dram";
+    }
+    return r;
+}
@@ -0,0 +1,193 @@
+#include "run_report.h"
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool valid_report_format(const std::string &format) {
+    return format == "json" || format == "csv";
+}
+
+// Value of a measured event, or NaN when it is not part of the event set
+static double counter(const PapitoResults &papi, const char *name) {
+    for (size_t i = 0; i < papi.event_names.size(); ++i) {
+        if (papi.event_names[i] == name) return double(papi.values[i]);
+    }
+    return NAN;
+}
+
+static double ratio(double num, double den) {
+    return (std::isnan(num) || std::isnan(den) || den == 0.0) ? NAN : num / den;
+}
+
+static std::string num(double v) {
+    if (!std::isfinite(v)) return "";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+static std::string json_num(double v) {
+    std::string s = num(v);
+    return s.empty() ? "null" : s;
+}
+
+static std::string json_str(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static std::string csv_field(const std::string &s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// Flat (name, value) list shared by both formats; NaN marks a missing number
+struct Field {
+    std::string name;
+    double value;
+    std::string str;
+    bool is_string;
+
+    Field(const char *n, double v) : name(n), value(v), is_string(false) {}
+    Field(const char *n, const std::string &s) : name(n), value(NAN), str(s), is_string(true) {}
+};
+
+static std::vector<Field> scalar_fields(const RunReport &r, const PapitoResults &papi) {
+    const double gflops = ratio(r.flops * 1e-9, r.timing.median);
+    const double gflops_best = ratio(r.flops * 1e-9, r.timing.min);
+    const double l2_dcm = counter(papi, "PAPI_L2_DCM");
+    return {
+        {"N", double(r.N)}, {"M", double(r.M)}, {"K", double(r.K)}, {"BS", double(r.BS)},
+        {"mode", r.mode}, {"runner", r.runner}, {"isa", r.isa}, {"dtype", r.dtype}, {"alloc", r.alloc}, {"numa", r.numa},
+        {"affinity", r.affinity}, {"cpus", r.cpus},
+        {"schedule", r.schedule}, {"sched_steals", r.sched_steals}, {"sched_imbalance", r.sched_imbalance},
+        {"seed", double(r.seed)}, {"threads", double(r.threads)}, {"batch", double(r.batch)},
+        {"warmup", double(r.warmup)}, {"repeats", double(r.repeats)},
+        {"min_s", r.timing.min}, {"median_s", r.timing.median}, {"p95_s", r.timing.p95},
+        {"mean_s", r.timing.mean}, {"stddev_s", r.timing.stddev},
+        {"pack_s", r.have_phases ? r.pack_seconds : NAN},
+        {"kernel_s", r.have_phases ? r.kernel_seconds : NAN},
+        {"checksum", r.checksum},
+        {"alloc_s", r.alloc_seconds}, {"fill_s", r.fill_seconds}, {"checksum_s", r.checksum_seconds},
+        {"gflops", gflops}, {"gflops_best", gflops_best},
+        {"energy_source", r.energy_source}, {"energy_j", r.energy_joules}, {"avg_w", r.energy_watts},
+        {"gflops_per_j", r.gflops_per_joule},
+        // counters cover all repeats, so rates are unaffected by the repeat count
+        {"ipc", ratio(counter(papi, "PAPI_TOT_INS"), counter(papi, "PAPI_TOT_CYC"))},
+        {"l1_dcm_rate", ratio(counter(papi, "PAPI_L1_DCM"), counter(papi, "PAPI_L1_DCA"))},
+        {"l2_dcm_rate", ratio(l2_dcm, l2_dcm + counter(papi, "PAPI_L2_DCH"))},
+        {"br_msp_rate", ratio(counter(papi, "PAPI_BR_MSP"), counter(papi, "PAPI_BR_INS"))},
+        {"dtlb_miss_rate", ratio(counter(papi, "PAPI_TLB_DM"), counter(papi, "PAPI_L1_DCA"))},
+        {"ghz", r.roofline.ghz}, {"flops_per_cycle", r.roofline.flops_per_cycle},
+        {"peak_gflops", r.roofline.peak_gflops}, {"peak_share", r.roofline.peak_share},
+        {"l2_bytes", r.roofline.l2_bytes}, {"dram_bytes", r.roofline.dram_bytes},
+        {"dram_source", std::string(r.roofline.dram_from_counters ? "counters" : "compulsory")},
+        {"ai_l2", r.roofline.ai_l2}, {"ai_dram", r.roofline.ai_dram},
+        {"l2_roof_gflops", r.roofline.l2_roof_gflops}, {"dram_roof_gflops", r.roofline.dram_roof_gflops},
+        {"bound", r.roofline.bound},
+        {"verify", r.verify ? r.verify_result.method : std::string()},
+        {"verify_ok", r.verify ? double(r.verify_result.ok) : NAN},
+        {"verify_max_abs", r.verify ? r.verify_result.max_abs : NAN},
+        {"verify_max_rel", r.verify ? r.verify_result.max_rel : NAN},
+        {"verify_mismatches", r.verify ? double(r.verify_result.mismatches) : NAN},
+    };
+}
+
+static void write_json(FILE *out, const RunReport &r, const PapitoResults &papi) {
+    std::string s = "{";
+    bool first = true;
+    for (const Field &f : scalar_fields(r, papi)) {
+        s += (first ? "" : ",") + json_str(f.name) + ":" + (f.is_string ? json_str(f.str) : json_num(f.value));
+        first = false;
+    }
+
+    s += ",\"papi\":{\"multiplexed\":" + std::string(papi.multiplexed ? "true" : "false") + ",\"counters\":{";
+    for (size_t i = 0; i < papi.event_names.size(); ++i) {
+        s += (i ? "," : "") + json_str(papi.event_names[i]) + ":" + std::to_string(papi.values[i]);
+    }
+    s += "},\"dropped\":[";
+    for (size_t i = 0; i < papi.dropped.size(); ++i) s += (i ? "," : "") + json_str(papi.dropped[i]);
+    s += "],\"regions\":[";
+    for (size_t ri = 0; ri < papi.regions.size(); ++ri) {
+        const PapitoRegionResult &reg = papi.regions[ri];
+        s += (ri ? "," : "") + std::string("{\"name\":") + json_str(reg.path)
+             + ",\"entries\":" + std::to_string(reg.entries) + ",\"counters\":{";
+        for (size_t i = 0; i < reg.values.size() && i < papi.event_names.size(); ++i) {
+            s += (i ? "," : "") + json_str(papi.event_names[i]) + ":" + std::to_string(reg.values[i]);
+        }
+        s += "}}";
+    }
+    s += "],\"threads\":[";
+    for (size_t ti = 0; ti < papi.threads.size(); ++ti) {
+        const PapitoThreadResult &t = papi.threads[ti];
+        s += (ti ? "," : "") + std::string("{\"thread\":") + std::to_string(t.thread)
+             + ",\"entries\":" + std::to_string(t.entries) + ",\"counters\":{";
+        for (size_t i = 0; i < t.values.size() && i < papi.event_names.size(); ++i) {
+            s += (i ? "," : "") + json_str(papi.event_names[i]) + ":" + std::to_string(t.values[i]);
+        }
+        s += "}}";
+    }
+    s += "]}}";
+    fprintf(out, "%s\n", s.c_str());
+}
+
+static void write_csv(FILE *out, const RunReport &r, const PapitoResults &papi) {
+    std::vector<std::pair<std::string, std::string>> cols;
+    for (const Field &f : scalar_fields(r, papi)) cols.emplace_back(f.name, f.is_string ? f.str : num(f.value));
+    cols.emplace_back("multiplexed", papi.multiplexed ? "1" : "0");
+    std::string dropped;
+    for (size_t i = 0; i < papi.dropped.size(); ++i) dropped += (i ? ";" : "") + papi.dropped[i];
+    cols.emplace_back("dropped", dropped);
+    for (size_t i = 0; i < papi.event_names.size(); ++i) {
+        cols.emplace_back(papi.event_names[i], std::to_string(papi.values[i]));
+    }
+    // Region columns are named <path>:entries and <path>:<event>
+    for (const PapitoRegionResult &reg : papi.regions) {
+        cols.emplace_back(reg.path + ":entries", std::to_string(reg.entries));
+        for (size_t i = 0; i < reg.values.size() && i < papi.event_names.size(); ++i) {
+            cols.emplace_back(reg.path + ":" + papi.event_names[i], std::to_string(reg.values[i]));
+        }
+    }
+
+    // Per-thread columns are named thread<i>:entries and thread<i>:<event>
+    for (const PapitoThreadResult &t : papi.threads) {
+        const std::string prefix = "thread" + std::to_string(t.thread) + ":";
+        cols.emplace_back(prefix + "entries", std::to_string(t.entries));
+        for (size_t i = 0; i < t.values.size() && i < papi.event_names.size(); ++i) {
+            cols.emplace_back(prefix + papi.event_names[i], std::to_string(t.values[i]));
+        }
+    }
+
+    std::string header, row;
+    for (size_t i = 0; i < cols.size(); ++i) {
+        header += (i ? "," : "") + csv_field(cols[i].first);
+        row += (i ? "," : "") + csv_field(cols[i].second);
+    }
+    fprintf(out, "%s\n%s\n", header.c_str(), row.c_str());
+}
+
+void write_run_report(FILE *out, const std::string &format, const RunReport &r, const PapitoResults &papi) {
+    if (format == "json") {
+        write_json(out, r, papi);
+    } else {
+        write_csv(out, r, papi);
+    }
+}
@@ -1,48 +1,397 @@
-#include "kernels.h"
-#include "matrix_utils.h" // Include the matrix utilities
+#include "runner.h"
+#include "pack_arena.h"
+#include "papito.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <cstdint>
 #include <cstdlib>
 #include <cstdio>
+#include <omp.h>
+#include <type_traits>
 
-// Utility functions for packing matrices
-static void pack_A_block(const double *A, double *packA, int N, int i0, int k0, int bs) {
-    for (int ii = 0; ii < bs; ++ii) {
-        const double *arow = &A[(i0 + ii) * N + k0];
-        double *prow = &packA[ii * bs];
-        for (int kk = 0; kk < bs; ++kk) prow[kk] = arow[kk];
+// papito region ids of the runner phases (regions are opt-in, see papito.h)
+static const int REGION_PACK_A = papito_region_id("pack_A");
+static const int REGION_PACK_B = papito_region_id("pack_B");
+static const int REGION_KERNEL = papito_region_id("kernel");
+
+// Element conversion at pack time: the reduced-precision runs keep float operands and
+// round them to bf16 only as they are copied into the packing buffers.
+template <typename P, typename T>
+static inline P pack_value(T v) {
+    if constexpr (std::is_same<P, bf16_t>::value) {
+        return float_to_bf16(float(v));
+    } else {
+        return P(v);
+    }
+}
+
+// Utility functions for packing matrices.
+// Edge blocks only copy their valid part, keeping a leading dimension of bs.
+// bf16 rows are zero-padded to an even k depth, since the kernel consumes k in pairs.
+template <typename T, typename P>
+static void pack_A_block(const T *A, P *packA, const GemmDims &d, int i0, int k0, int bs) {
+    const int mb = std::min(bs, d.M - i0);
+    const int kb = std::min(bs, d.K - k0);
+    for (int ii = 0; ii < mb; ++ii) {
+        const T *arow = &A[(i0 + ii) * d.lda + k0];
+        P *prow = &packA[ii * bs];
+        for (int kk = 0; kk < kb; ++kk) prow[kk] = pack_value<P>(arow[kk]);
+        if constexpr (std::is_same<P, bf16_t>::value) {
+            if (kb & 1) prow[kb] = bf16_t{0};
+        }
+    }
+}
+
+// bf16 uses the k-pair layout of kernels.h; the other types the plain packB[kk*bs + jj] one
+template <typename T, typename P>
+static void pack_B_block(const T *B, P *packB, const GemmDims &d, int k0, int j0, int bs) {
+    const int nb = std::min(bs, d.N - j0);
+    const int kb = std::min(bs, d.K - k0);
+    if constexpr (std::is_same<P, bf16_t>::value) {
+        for (int kk = 0; kk < kb; ++kk) {
+            const T *brow = &B[(k0 + kk) * d.ldb + j0];
+            P *ppair = &packB[(kk / 2) * 2 * bs + (kk & 1)];
+            for (int jj = 0; jj < nb; ++jj) ppair[2 * jj] = pack_value<P>(brow[jj]);
+        }
+        if (kb & 1) {
+            P *ppair = &packB[(kb / 2) * 2 * bs + 1];
+            for (int jj = 0; jj < nb; ++jj) ppair[2 * jj] = bf16_t{0};
+        }
+    } else {
+        for (int kk = 0; kk < kb; ++kk) {
+            const T *brow = &B[(k0 + kk) * d.ldb + j0];
+            P *prow = &packB[kk * bs];
+            for (int jj = 0; jj < nb; ++jj) prow[jj] = pack_value<P>(brow[jj]);
+        }
+    }
+}
+
+// Blocked GEMM loop nest over caller-provided BS x BS packing buffers.
+// The papito regions are no-ops when called from the batched runner's parallel region.
+template <typename T, typename P>
+static void block_gemm(const T *A, const T *B, T *C, const GemmDims &d, int BS,
+                       matmul_kernel_t<T, P> kernel, P *packA, P *packB) {
+    for (int i0 = 0; i0 < d.M; i0 += BS) {
+        for (int k0 = 0; k0 < d.K; k0 += BS) {
+            papito_region_begin_id(REGION_PACK_A);
+            pack_A_block(A, packA, d, i0, k0, BS);
+            papito_region_end_id(REGION_PACK_A);
+            for (int j0 = 0; j0 < d.N; j0 += BS) {
+                papito_region_begin_id(REGION_PACK_B);
+                pack_B_block(B, packB, d, k0, j0, BS);
+                papito_region_end_id(REGION_PACK_B);
+                papito_region_begin_id(REGION_KERNEL);
+                kernel(packA, packB, C, d.M, d.N, d.K, d.ldc, i0, j0, k0, BS);
+                papito_region_end_id(REGION_KERNEL);
+            }
+        }
     }
 }
 
-static void pack_B_block(const double *B, double *packB, int N, int k0, int j0, int bs) {
-    for (int kk = 0; kk < bs; ++kk) {
-        const double *brow = &B[(k0 + kk) * N + j0];
-        double *prow = &packB[kk * bs];
-        for (int jj = 0; jj < bs; ++jj) prow[jj] = brow[jj];
+bool reserve_pack_workspace(const std::string &runner, const GemmDims &d, int BS, const GotoBlocking &blk,
+                            int num_threads) {
+    size_t a_elems = size_t(BS) * BS, b_elems = size_t(BS) * BS;
+    if (runner == "bpanel") {
+        b_elems = size_t(BS) * ((d.N + BS - 1) / BS) * BS;
+    } else if (runner == "goto") {
+        a_elems = size_t(blk.MC) * blk.KC;
+        b_elems = size_t(blk.KC) * blk.NC;
     }
+    return pack_arena::reserve(a_elems, b_elems, num_threads);
 }
 
 // The main benchmark loop
-void run_benchmark(const double *A, const double *B, double *C, int N, int BS, matmul_func_t kernel) {
-    // Use the utility to allocate aligned packing buffers
-    double *packA = matrix_utils::alloc(BS);
-    double *packB = matrix_utils::alloc(BS);
+template <typename T, typename P>
+void run_benchmark(const T *A, const T *B, T *C, const GemmDims &d, int BS, matmul_kernel_t<T, P> kernel) {
+    P *packA, *packB;
+    if (!pack_arena::acquire_as(size_t(BS) * BS, size_t(BS) * BS, &packA, &packB)) {
+        perror("Failed to allocate packing buffers");
+        return;
+    }
+
+    block_gemm(A, B, C, d, BS, kernel, packA, packB);
+}
+
+// Batched variant: entries are spread across threads, and each thread reuses its
+// packing workspace for every entry it computes.
+template <typename T, typename P>
+void run_benchmark_batched(const T *const *As, const T *const *Bs, T *const *Cs, int batch,
+                           const GemmDims &d, int BS, matmul_kernel_t<T, P> kernel, int num_threads) {
+    bool alloc_failed = false;
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        P *packA = nullptr, *packB = nullptr;
+        if (!pack_arena::acquire_as(size_t(BS) * BS, size_t(BS) * BS, &packA, &packB)) {
+            #pragma omp critical
+            {
+                perror("Failed to allocate packing buffers");
+                alloc_failed = true;
+            }
+        }
+        #pragma omp barrier
+
+        papito_thread_begin();
+        if (!alloc_failed) {
+            #pragma omp for schedule(static)
+            for (int b = 0; b < batch; ++b) {
+                block_gemm(As[b], Bs[b], Cs[b], d, BS, kernel, packA, packB);
+            }
+        }
+        papito_thread_end();
+    }
+}
+
+// Parallel variant: the (i0, j0) tiles of C are split across threads. Each tile is
+// owned by exactly one thread, which runs the whole k0 reduction for it using its
+// own packing buffers, so no two threads ever write the same part of C. With the steal
+// schedule the ownership is decided at run time: threads start on their static range of
+// task_tiles-tile tasks and, once it is drained, take tasks from the back of other ranges.
+template <typename T, typename P>
+void run_benchmark_parallel(const T *A, const T *B, T *C, const GemmDims &d, int BS,
+                            matmul_kernel_t<T, P> kernel, int num_threads,
+                            TileSchedule schedule, SchedStats *stats, TileQueues *queues) {
+    using clock = std::chrono::steady_clock;
+    const int mblocks = (d.M + BS - 1) / BS;
+    const int nblocks = (d.N + BS - 1) / BS;
+    const int ntiles = mblocks * nblocks;
+    const bool steal = schedule == TileSchedule::steal;
+    const int task_tiles = steal ? steal_task_tiles(d, BS, num_threads) : 1;
+    const long ntasks = (ntiles + task_tiles - 1) / task_tiles;
+    if (steal) {
+        if (!queues || !queues->reserve(num_threads)) {
+            fprintf(stderr, "Error: the steal schedule needs tile deques for %d threads.\n", num_threads);
+            return;
+        }
+        queues->reset(ntasks, num_threads);
+    }
+    if (stats) {
+        stats->task_tiles = task_tiles;
+        stats->tasks = ntasks;
+        if (int(stats->threads.size()) < num_threads) stats->threads.resize(num_threads);
+    }
+    bool alloc_failed = false;
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        P *packA = nullptr, *packB = nullptr;
+        if (!pack_arena::acquire_as(size_t(BS) * BS, size_t(BS) * BS, &packA, &packB)) {
+            #pragma omp critical
+            {
+                perror("Failed to allocate packing buffers");
+                alloc_failed = true;
+            }
+        }
+        #pragma omp barrier
+
+        auto run_tile = [&](int t) {
+            int i0 = (t / nblocks) * BS;
+            int j0 = (t % nblocks) * BS;
+            for (int k0 = 0; k0 < d.K; k0 += BS) {
+                pack_A_block(A, packA, d, i0, k0, BS);
+                pack_B_block(B, packB, d, k0, j0, BS);
+                kernel(packA, packB, C, d.M, d.N, d.K, d.ldc, i0, j0, k0, BS);
+            }
+        };
+
+        papito_thread_begin();
+        ThreadSchedStats local;
+        if (!alloc_failed && !steal) {
+            auto t0 = clock::now();
+            #pragma omp for schedule(static) nowait
+            for (int t = 0; t < ntiles; ++t) {
+                run_tile(t);
+                ++local.tiles;
+            }
+            local.busy_seconds = std::chrono::duration<double>(clock::now() - t0).count();
+        } else if (!alloc_failed) {
+            const int tid = omp_get_thread_num();
+            long task;
+            for (;;) {
+                if (!queues->pop(tid, &task)) {
+                    if (!queues->steal(tid, &task)) break;
+                    ++local.steals;
+                }
+                auto t0 = clock::now();
+                const int end = int(std::min<long>(ntiles, (task + 1) * task_tiles));
+                for (int t = int(task * task_tiles); t < end; ++t) {
+                    run_tile(t);
+                    ++local.tiles;
+                }
+                local.busy_seconds += std::chrono::duration<double>(clock::now() - t0).count();
+            }
+        }
+        papito_thread_end();
+
+        if (stats) {
+            ThreadSchedStats &acc = stats->threads[omp_get_thread_num()];
+            acc.busy_seconds += local.busy_seconds;
+            acc.tiles += local.tiles;
+            acc.steals += local.steals;
+        }
+    }
+}
+
+// The element-type combinations used by main (f64, f32 and bf16-into-f32)
+#define INSTANTIATE_BLOCK_RUNNERS(T, P) \
+    template void run_benchmark<T, P>(const T *, const T *, T *, const GemmDims &, int, matmul_kernel_t<T, P>); \
+    template void run_benchmark_batched<T, P>(const T *const *, const T *const *, T *const *, int, \
+                                              const GemmDims &, int, matmul_kernel_t<T, P>, int); \
+    template void run_benchmark_parallel<T, P>(const T *, const T *, T *, const GemmDims &, int, \
+                                               matmul_kernel_t<T, P>, int, TileSchedule, SchedStats *, \
+                                               TileQueues *);
+INSTANTIATE_BLOCK_RUNNERS(double, double)
+INSTANTIATE_BLOCK_RUNNERS(float, float)
+INSTANTIATE_BLOCK_RUNNERS(float, bf16_t)
+
+// Packs a full BS x N k-panel of B as ceil(N/BS) consecutive bs x bs blocks, so the block
+// for column offset j0 starts at panelB + (j0 / bs) * bs * bs and has the usual
+// packB[kk*bs + jj] layout expected by the kernels.
+static void pack_B_panel(const double *B, double *panelB, const GemmDims &d, int k0, int bs) {
+    for (int j0 = 0; j0 < d.N; j0 += bs) {
+        pack_B_block(B, &panelB[size_t(j0 / bs) * bs * bs], d, k0, j0, bs);
+    }
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
 
-    if (!packA || !packB) {
+// Same computation as run_benchmark, but each k-panel of B is packed once and reused
+// across all i0 row-blocks instead of being repacked M/BS times.
+void run_benchmark_bpanel(const double *A, const double *B, double *C, const GemmDims &d, int BS,
+                          matmul_func_t kernel, RunnerPhaseTimes *times) {
+    const int nblocks = (d.N + BS - 1) / BS;
+    double *packA, *panelB;
+    if (!pack_arena::acquire(size_t(BS) * BS, size_t(BS) * nblocks * BS, &packA, &panelB)) {
         perror("Failed to allocate packing buffers");
         return;
     }
 
-    for (int i0 = 0; i0 < N; i0 += BS) {
-        for (int k0 = 0; k0 < N; k0 += BS) {
-            pack_A_block(A, packA, N, i0, k0, BS);
-            for (int j0 = 0; j0 < N; j0 += BS) {
-                pack_B_block(B, packB, N, k0, j0, BS);
-                kernel(packA, packB, C, N, i0, j0, k0, BS);
+    RunnerPhaseTimes local;
+    for (int k0 = 0; k0 < d.K; k0 += BS) {
+        auto t = std::chrono::steady_clock::now();
+        papito_region_begin_id(REGION_PACK_B);
+        pack_B_panel(B, panelB, d, k0, BS);
+        papito_region_end_id(REGION_PACK_B);
+        local.pack_seconds += seconds_since(t);
+
+        for (int i0 = 0; i0 < d.M; i0 += BS) {
+            t = std::chrono::steady_clock::now();
+            papito_region_begin_id(REGION_PACK_A);
+            pack_A_block(A, packA, d, i0, k0, BS);
+            papito_region_end_id(REGION_PACK_A);
+            local.pack_seconds += seconds_since(t);
+
+            t = std::chrono::steady_clock::now();
+            papito_region_begin_id(REGION_KERNEL);
+            for (int j0 = 0; j0 < d.N; j0 += BS) {
+                kernel(packA, &panelB[size_t(j0 / BS) * BS * BS], C, d.M, d.N, d.K, d.ldc, i0, j0, k0, BS);
             }
+            papito_region_end_id(REGION_KERNEL);
+            local.kernel_seconds += seconds_since(t);
+        }
+    }
+    if (times) *times = local;
+}
+
+// Rounds v down to a multiple of bs, clamped to [bs, limit rounded up to bs].
+static int round_block(long v, int bs, int limit) {
+    long max_v = ((long(limit) + bs - 1) / bs) * bs;
+    long r = (v / bs) * bs;
+    return int(std::max<long>(bs, std::min(r, max_v)));
+}
+
+GotoBlocking goto_blocking_from_cache(long l2_bytes, long l3_bytes, const GemmDims &d, int BS) {
+    // Fallbacks when the cache size query returned nothing
+    if (l2_bytes <= 0) l2_bytes = 256L * 1024;
+    if (l3_bytes <= 0) l3_bytes = 8L * 1024 * 1024;
+
+    GotoBlocking blk;
+    // Packed MC x KC block of A takes about half of L2 (square, so it is also the reuse panel for C)
+    long kc = long(std::sqrt(double(l2_bytes / 2) / sizeof(double)));
+    blk.KC = round_block(kc, BS, d.K);
+    // Give MC the L2 budget KC left unused when K is small
+    blk.MC = round_block((l2_bytes / 2) / (long(sizeof(double)) * blk.KC), BS, d.M);
+    // Packed KC x NC panel of B takes about half of L3
+    long nc = (l3_bytes / 2) / (long(sizeof(double)) * blk.KC);
+    blk.NC = round_block(nc, BS, d.N);
+    return blk;
+}
+
+// Packs an mc x kc block of A (starting at i0, k0) as bs x bs tiles, tile (ib, kb) at
+// ((ib * kc_tiles) + kb) * bs * bs, each with the packA[ii*bs + kk] layout.
+static void pack_A_goto(const double *A, double *packA, const GemmDims &d, int i0, int k0, int mc, int kc, int bs) {
+    int kc_tiles = (kc + bs - 1) / bs;
+    for (int ib = 0; ib < (mc + bs - 1) / bs; ++ib) {
+        for (int kb = 0; kb < kc_tiles; ++kb) {
+            pack_A_block(A, &packA[size_t(ib * kc_tiles + kb) * bs * bs], d, i0 + ib * bs, k0 + kb * bs, bs);
+        }
+    }
+}
+
+// Packs a kc x nc panel of B (starting at k0, j0) as bs x bs tiles, tile (kb, jb) at
+// ((jb * kc_tiles) + kb) * bs * bs, each with the packB[kk*bs + jj] layout.
+static void pack_B_goto(const double *B, double *packB, const GemmDims &d, int k0, int j0, int kc, int nc, int bs) {
+    int kc_tiles = (kc + bs - 1) / bs;
+    for (int jb = 0; jb < (nc + bs - 1) / bs; ++jb) {
+        for (int kb = 0; kb < kc_tiles; ++kb) {
+            pack_B_block(B, &packB[size_t(jb * kc_tiles + kb) * bs * bs], d, k0 + kb * bs, j0 + jb * bs, bs);
         }
     }
+}
+
+// GotoBLAS-style five-loop blocking: jc (NC, L3 panel of B) -> pc (KC) -> ic (MC, L2 block of A)
+// -> jr/ir (BS micro-blocks) -> kr, with the block kernel as the innermost compute.
+void run_benchmark_goto(const double *A, const double *B, double *C, const GemmDims &d, int BS,
+                        const GotoBlocking &blk, matmul_func_t kernel, RunnerPhaseTimes *times) {
+    const int MC = blk.MC, KC = blk.KC, NC = blk.NC;
+    double *packA, *packB;
+    if (!pack_arena::acquire(size_t(MC) * KC, size_t(KC) * NC, &packA, &packB)) {
+        perror("Failed to allocate packing buffers");
+        return;
+    }
+
+    RunnerPhaseTimes local;
+    for (int jc = 0; jc < d.N; jc += NC) {
+        int nc = std::min(NC, d.N - jc);
+        for (int pc = 0; pc < d.K; pc += KC) {
+            int kc = std::min(KC, d.K - pc);
+            int kc_tiles = (kc + BS - 1) / BS;
+
+            auto t = std::chrono::steady_clock::now();
+            papito_region_begin_id(REGION_PACK_B);
+            pack_B_goto(B, packB, d, pc, jc, kc, nc, BS);
+            papito_region_end_id(REGION_PACK_B);
+            local.pack_seconds += seconds_since(t);
 
-    free(packA);
-    free(packB);
+            for (int ic = 0; ic < d.M; ic += MC) {
+                int mc = std::min(MC, d.M - ic);
+
+                t = std::chrono::steady_clock::now();
+                papito_region_begin_id(REGION_PACK_A);
+                pack_A_goto(A, packA, d, ic, pc, mc, kc, BS);
+                papito_region_end_id(REGION_PACK_A);
+                local.pack_seconds += seconds_since(t);
+
+                t = std::chrono::steady_clock::now();
+                papito_region_begin_id(REGION_KERNEL);
+                for (int jr = 0; jr < nc; jr += BS) {
+                    const double *btiles = &packB[size_t(jr / BS) * kc_tiles * BS * BS];
+                    for (int ir = 0; ir < mc; ir += BS) {
+                        const double *atiles = &packA[size_t(ir / BS) * kc_tiles * BS * BS];
+                        for (int kb = 0; kb < kc_tiles; ++kb) {
+                            kernel(&atiles[size_t(kb) * BS * BS], &btiles[size_t(kb) * BS * BS], C,
+                                   d.M, d.N, d.K, d.ldc, ic + ir, jc + jr, pc + kb * BS, BS);
+                        }
+                    }
+                }
+                papito_region_end_id(REGION_KERNEL);
+                local.kernel_seconds += seconds_since(t);
+            }
+        }
+    }
+    if (times) *times = local;
 }
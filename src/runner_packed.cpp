@@ -0,0 +1,69 @@
+#include "runner_packed.h"
+#include "pack_arena.h"
+#include "papito.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+
+// papito region ids of the runner phases (regions are opt-in, see papito.h)
+static const int REGION_PACK_A = papito_region_id("pack_A");
+static const int REGION_PACK_B = papito_region_id("pack_B");
+static const int REGION_KERNEL = papito_region_id("kernel");
+
+// Edge blocks are packed partially, with the same sliver offsets.
+
+// Packs a bs x bs block of A into MR-row slivers, each stored column-interleaved so the
+// kernel reads the h values of column kk as one contiguous run.
+static void pack_A_slivers(const double *A, double *packA, const GemmDims &d, int i0, int k0, int bs) {
+    const int mb = std::min(bs, d.M - i0);
+    const int kb = std::min(bs, d.K - k0);
+    for (int ii = 0; ii < mb; ii += PACK_MR) {
+        int h = std::min(PACK_MR, mb - ii);
+        double *sliver = &packA[ii * bs];
+        for (int kk = 0; kk < kb; ++kk) {
+            for (int r = 0; r < h; ++r) {
+                sliver[kk * h + r] = A[(i0 + ii + r) * d.lda + k0 + kk];
+            }
+        }
+    }
+}
+
+// Packs a bs x bs block of B into NR-column slivers, each stored row-interleaved so
+// consecutive kk rows of the sliver are adjacent in memory.
+static void pack_B_slivers(const double *B, double *packB, const GemmDims &d, int k0, int j0, int bs) {
+    const int nb = std::min(bs, d.N - j0);
+    const int kb = std::min(bs, d.K - k0);
+    for (int jj = 0; jj < nb; jj += PACK_NR) {
+        int w = std::min(PACK_NR, nb - jj);
+        double *sliver = &packB[jj * bs];
+        for (int kk = 0; kk < kb; ++kk) {
+            const double *brow = &B[(k0 + kk) * d.ldb + j0 + jj];
+            for (int c = 0; c < w; ++c) sliver[kk * w + c] = brow[c];
+        }
+    }
+}
+
+void run_benchmark_packed(const double *A, const double *B, double *C, const GemmDims &d, int BS,
+                          matmul_packed_func_t kernel) {
+    double *packA, *packB;
+    if (!pack_arena::acquire(size_t(BS) * BS, size_t(BS) * BS, &packA, &packB)) {
+        perror("Failed to allocate packing buffers");
+        return;
+    }
+
+    for (int i0 = 0; i0 < d.M; i0 += BS) {
+        for (int k0 = 0; k0 < d.K; k0 += BS) {
+            papito_region_begin_id(REGION_PACK_A);
+            pack_A_slivers(A, packA, d, i0, k0, BS);
+            papito_region_end_id(REGION_PACK_A);
+            for (int j0 = 0; j0 < d.N; j0 += BS) {
+                papito_region_begin_id(REGION_PACK_B);
+                pack_B_slivers(B, packB, d, k0, j0, BS);
+                papito_region_end_id(REGION_PACK_B);
+                papito_region_begin_id(REGION_KERNEL);
+                kernel(packA, packB, C, d.M, d.N, d.K, d.ldc, i0, j0, k0, BS);
+                papito_region_end_id(REGION_KERNEL);
+            }
+        }
+    }
+}
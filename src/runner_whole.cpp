@@ -1,6 +1,32 @@
 #include "runner_whole.h"
+#include "papito.h"
 
-void run_benchmark_whole_matrix(const double *A, const double *B, double *C, int N, matmul_whole_func_t kernel) {
+static void whole_product(const double *A, const double *B, double *C, const GemmDims &d,
+                          const WholeKernel &kernel) {
+    if (kernel.strassen) {
+        strassen_gemm(*kernel.strassen, A, B, C, d.M, d.N, d.K, d.lda, d.ldb, d.ldc);
+    } else if (kernel.morton) {
+        morton_gemm(*kernel.morton, A, B, C, d.M, d.N, d.K, d.lda, d.ldb, d.ldc);
+    } else {
+        kernel.func(A, B, C, d.M, d.N, d.K, d.lda, d.ldb, d.ldc);
+    }
+}
+
+void run_benchmark_whole_matrix(const double *A, const double *B, double *C, const GemmDims &d,
+                                const WholeKernel &kernel) {
     // Simply call the kernel once on the entire matrices.
-    kernel(A, B, C, N);
+    whole_product(A, B, C, d, kernel);
+}
+
+void run_benchmark_whole_batched(const double *const *As, const double *const *Bs, double *const *Cs, int batch,
+                                 const GemmDims &d, const WholeKernel &kernel, int num_threads) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        papito_thread_begin();
+        #pragma omp for schedule(static)
+        for (int b = 0; b < batch; ++b) {
+            whole_product(As[b], Bs[b], Cs[b], d, kernel);
+        }
+        papito_thread_end();
+    }
 }
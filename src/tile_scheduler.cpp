@@ -0,0 +1,83 @@
+#include "tile_scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+// Minimum FLOPs per steal task and tasks each thread should have to balance with
+#ifndef STEAL_TASK_FLOPS
+#define STEAL_TASK_FLOPS (4.0 * 1024 * 1024)
+#endif
+
+#ifndef STEAL_TASKS_PER_THREAD
+#define STEAL_TASKS_PER_THREAD 8
+#endif
+
+bool parse_tile_schedule(const std::string &name, TileSchedule *out) {
+    if (name == "static") { *out = TileSchedule::static_split; return true; }
+    if (name == "steal") { *out = TileSchedule::steal; return true; }
+    return false;
+}
+
+const char* tile_schedule_name(TileSchedule s) {
+    return s == TileSchedule::steal ? "steal" : "static";
+}
+
+int steal_task_tiles(const GemmDims &d, int BS, int num_threads) {
+    const long ntiles = long((d.M + BS - 1) / BS) * ((d.N + BS - 1) / BS);
+    const double tile_flops = 2.0 * BS * BS * d.K;
+    long tiles = long(std::ceil(STEAL_TASK_FLOPS / tile_flops));
+    tiles = std::min(tiles, std::max(1L, ntiles / (long(STEAL_TASKS_PER_THREAD) * num_threads)));
+    return int(std::max(1L, tiles));
+}
+
+static uint64_t pack(uint64_t head, uint64_t tail) { return head << 32 | tail; }
+
+bool TileQueues::reserve(int nthreads) {
+    if (nthreads <= capacity_) return true;
+    std::unique_ptr<Deque[]> grown(new (std::nothrow) Deque[nthreads]);
+    if (!grown) return false;
+    deques_ = std::move(grown);
+    capacity_ = nthreads;
+    return true;
+}
+
+void TileQueues::reset(long ntasks, int nthreads) {
+    nthreads_ = nthreads;
+    // Same split as omp for schedule(static): the first ntasks % nthreads get one extra
+    const long base = ntasks / nthreads, extra = ntasks % nthreads;
+    long begin = 0;
+    for (int t = 0; t < nthreads; ++t) {
+        const long end = begin + base + (t < extra ? 1 : 0);
+        deques_[t].range.store(pack(begin, end), std::memory_order_relaxed);
+        begin = end;
+    }
+}
+
+bool TileQueues::pop(int tid, long *task) {
+    std::atomic<uint64_t> &range = deques_[tid].range;
+    uint64_t r = range.load(std::memory_order_relaxed);
+    for (;;) {
+        const uint64_t head = r >> 32, tail = r & 0xffffffffu;
+        if (head >= tail) return false;
+        if (range.compare_exchange_weak(r, pack(head + 1, tail), std::memory_order_relaxed)) {
+            *task = long(head);
+            return true;
+        }
+    }
+}
+
+bool TileQueues::steal(int tid, long *task) {
+    for (int i = 1; i < nthreads_; ++i) {
+        std::atomic<uint64_t> &range = deques_[(tid + i) % nthreads_].range;
+        uint64_t r = range.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint64_t head = r >> 32, tail = r & 0xffffffffu;
+            if (head >= tail) break;
+            if (range.compare_exchange_weak(r, pack(head, tail - 1), std::memory_order_relaxed)) {
+                *task = long(tail - 1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,103 @@
+#include "verify.h"
+#include "kernels_whole.h"
+#include "matrix_utils.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Records one compared value; rel is the error already divided by its scale
+static void record(VerifyResult *res, double abs_err, double rel, double rtol, int b, int i, int j) {
+    if (!(abs_err <= res->max_abs)) res->max_abs = abs_err; // NaN propagates as a failure
+    if (!(rel <= res->max_rel)) res->max_rel = rel;
+    if (!(rel <= rtol)) {
+        if (res->mismatches++ == 0) {
+            res->first_batch = b;
+            res->first_row = i;
+            res->first_col = j;
+        }
+        res->ok = false;
+    }
+}
+
+bool verify_blas(const double *A, const double *B, const double *C, const GemmDims &d, int batch,
+                 double rtol, VerifyResult *res) {
+    *res = VerifyResult();
+    res->method = "blas";
+    double *ref = matrix_utils::alloc(d.M, d.N);
+    if (!ref) return false;
+
+    for (int b = 0; b < batch; ++b) {
+        const double *Ab = A + size_t(b) * d.M * d.lda;
+        const double *Bb = B + size_t(b) * d.K * d.ldb;
+        const double *Cb = C + size_t(b) * d.M * d.ldc;
+        kernel_blas_whole(Ab, Bb, ref, d.M, d.N, d.K, d.lda, d.ldb, d.N);
+        for (int i = 0; i < d.M; ++i) {
+            for (int j = 0; j < d.N; ++j) {
+                double r = ref[size_t(i) * d.N + j];
+                double err = std::fabs(Cb[size_t(i) * d.ldc + j] - r);
+                double rel = err == 0.0 ? 0.0 : err / std::fabs(r);
+                record(res, err, rel, rtol, b, i, j);
+            }
+        }
+    }
+    free(ref);
+    return true;
+}
+
+bool verify_freivalds(const double *A, const double *B, const double *C, const GemmDims &d, int batch,
+                      double rtol, unsigned int seed, int vectors, VerifyResult *res) {
+    *res = VerifyResult();
+    res->method = "freivalds";
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> x(d.N), bx(d.K), babs(d.K), cx(d.M);
+    std::vector<char> bad_row(d.M);
+    // |C x - A (B x)| <= ~(2K + N) u (|A| |B| |x|)_i for a correct C: C itself carries gamma_K,
+    // and the two checking products add gamma_N and gamma_K
+    if (rtol <= 0.0) rtol = (2.0 * d.K + d.N + 4) * (DBL_EPSILON / 2);
+
+    for (int b = 0; b < batch; ++b) {
+        const double *Ab = A + size_t(b) * d.M * d.lda;
+        const double *Bb = B + size_t(b) * d.K * d.ldb;
+        const double *Cb = C + size_t(b) * d.M * d.ldc;
+        std::fill(bad_row.begin(), bad_row.end(), 0);
+        for (int v = 0; v < vectors; ++v) {
+            for (double &xi : x) xi = dist(rng);
+
+            // bx = B x and babs = |B| |x|
+            for (int k = 0; k < d.K; ++k) {
+                const double *brow = Bb + size_t(k) * d.ldb;
+                double s = 0.0, sa = 0.0;
+                for (int j = 0; j < d.N; ++j) {
+                    s += brow[j] * x[j];
+                    sa += std::fabs(brow[j]) * std::fabs(x[j]);
+                }
+                bx[k] = s;
+                babs[k] = sa;
+            }
+            for (int i = 0; i < d.M; ++i) {
+                const double *crow = Cb + size_t(i) * d.ldc;
+                const double *arow = Ab + size_t(i) * d.lda;
+                double c = 0.0, ref = 0.0, scale = 0.0;
+                for (int j = 0; j < d.N; ++j) c += crow[j] * x[j];
+                for (int k = 0; k < d.K; ++k) {
+                    ref += arow[k] * bx[k];
+                    scale += std::fabs(arow[k]) * babs[k];
+                }
+                double err = std::fabs(c - ref);
+                double rel = err == 0.0 ? 0.0 : err / scale;
+                // A row counts once even if several vectors catch it
+                const long before = res->mismatches;
+                record(res, err, rel, rtol, b, i, -1);
+                if (res->mismatches != before) {
+                    if (bad_row[i]) res->mismatches--;
+                    bad_row[i] = 1;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,218 @@
+/*
+ * tests/api_test.c
+ * Plain C user of include/matmul.h: checks products and error paths of the C API against
+ * a naive reference. Built twice by `make test`, against lib/libmatmul.a and
+ * lib/libmatmul.so, and run from scripts/sanity_check.sh.
+ */
+#include "matmul.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                         \
+    do {                                                         \
+        if (!(cond)) {                                           \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);                        \
+            fprintf(stderr, "\n");                               \
+            ++failures;                                          \
+        }                                                        \
+    } while (0)
+
+#define CHECK_STATUS(call, expected)                                       \
+    do {                                                                   \
+        const matmul_status st_ = (call);                                  \
+        CHECK(st_ == (expected), "%s returned '%s', expected '%s'", #call, \
+              matmul_status_string(st_), matmul_status_string(expected));  \
+    } while (0)
+
+static double *alloc_filled(size_t n, unsigned seed) {
+    double *p = malloc(sizeof(double) * n);
+    if (!p) {
+        perror("malloc");
+        exit(1);
+    }
+    srand(seed);
+    for (size_t i = 0; i < n; ++i) p[i] = (double)rand() / RAND_MAX - 0.5;
+    return p;
+}
+
+/* C = A * B for row-major operands with leading dimensions */
+static void reference(int M, int N, int K, const double *A, int lda, const double *B, int ldb,
+                      double *C, int ldc) {
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            double s = 0.0;
+            for (int k = 0; k < K; ++k) s += A[(size_t)i * lda + k] * B[(size_t)k * ldb + j];
+            C[(size_t)i * ldc + j] = s;
+        }
+    }
+}
+
+/* Largest difference of the M x N products, relative to the largest reference element
+ * (elementwise ratios blow up on sums that cancel, and strassen reorders them) */
+static double max_rel_diff(int M, int N, const double *C, const double *R, int ldc) {
+    double worst = 0.0, scale = 0.0;
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            const double r = R[(size_t)i * ldc + j];
+            const double d = fabs(C[(size_t)i * ldc + j] - r);
+            if (d > worst) worst = d;
+            if (fabs(r) > scale) scale = fabs(r);
+        }
+    }
+    return worst / scale;
+}
+
+/* Strassen recursing at these small test sizes, with a block leaf */
+static void small_strassen(matmul_ctx *ctx, const char *mode) {
+    if (strcmp(mode, "strassen") == 0) CHECK_STATUS(matmul_set_strassen(ctx, 16, 2, "avx"), MATMUL_OK);
+}
+
+#define RTOL 1e-10
+
+/* One rectangular dgemm with sizes BS does not divide and padded leading dimensions */
+static void test_dgemm(const char *mode, int bs, int num_threads) {
+    const int M = 131, N = 100, K = 77, lda = K + 3, ldb = N + 5, ldc = N + 1;
+    double *A = alloc_filled((size_t)M * lda, 1), *B = alloc_filled((size_t)K * ldb, 2);
+    double *C = alloc_filled((size_t)M * ldc, 3), *R = alloc_filled((size_t)M * ldc, 4);
+    matmul_ctx *ctx = NULL;
+    CHECK_STATUS(matmul_create(num_threads, 0, &ctx), MATMUL_OK);
+    if (ctx) {
+        small_strassen(ctx, mode);
+        CHECK_STATUS(matmul_select(ctx, mode, bs), MATMUL_OK);
+        CHECK_STATUS(matmul_dgemm(ctx, M, N, K, A, lda, B, ldb, C, ldc), MATMUL_OK);
+        reference(M, N, K, A, lda, B, ldb, R, ldc);
+        const double diff = max_rel_diff(M, N, C, R, ldc);
+        CHECK(diff < RTOL, "dgemm %s (BS %d, %d threads): max relative error %g", mode, bs, num_threads, diff);
+        matmul_destroy(ctx);
+    }
+    free(A); free(B); free(C); free(R);
+}
+
+/* batch > 1 through matmul_gemm, with entries strided apart */
+static void test_batch(const char *mode, int bs, int num_threads) {
+    const int M = 70, N = 45, K = 33, batch = 3;
+    const long long sa = (long long)M * K + 8, sb = (long long)K * N + 8, sc = (long long)M * N + 8;
+    double *A = alloc_filled((size_t)(sa * batch), 5), *B = alloc_filled((size_t)(sb * batch), 6);
+    double *C = alloc_filled((size_t)(sc * batch), 7), *R = alloc_filled((size_t)M * N, 8);
+    matmul_ctx *ctx = NULL;
+    CHECK_STATUS(matmul_create(num_threads, 0, &ctx), MATMUL_OK);
+    if (ctx) {
+        small_strassen(ctx, mode);
+        CHECK_STATUS(matmul_select(ctx, mode, bs), MATMUL_OK);
+        matmul_gemm_desc g;
+        memset(&g, 0, sizeof(g));
+        g.M = M; g.N = N; g.K = K;
+        g.A = A; g.lda = K; g.stride_a = sa;
+        g.B = B; g.ldb = N; g.stride_b = sb;
+        g.C = C; g.ldc = N; g.stride_c = sc;
+        g.batch = batch;
+        CHECK_STATUS(matmul_gemm(ctx, &g), MATMUL_OK);
+        for (int b = 0; b < batch; ++b) {
+            reference(M, N, K, A + b * sa, K, B + b * sb, N, R, N);
+            const double diff = max_rel_diff(M, N, C + b * sc, R, N);
+            CHECK(diff < RTOL, "batch %s entry %d: max relative error %g", mode, b, diff);
+        }
+        matmul_destroy(ctx);
+    }
+    free(A); free(B); free(C); free(R);
+}
+
+static void test_errors(void) {
+    const int n = 64;
+    double *A = alloc_filled((size_t)n * n, 9), *B = alloc_filled((size_t)n * n, 10);
+    double *C = alloc_filled((size_t)n * n, 11);
+    matmul_ctx *ctx = NULL;
+
+    CHECK_STATUS(matmul_create(0, 0, &ctx), MATMUL_ERR_ARG);
+    CHECK_STATUS(matmul_create(1, 0, &ctx), MATMUL_OK);
+    if (!ctx) return;
+    CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n, B, n, C, n), MATMUL_ERR_NO_KERNEL);
+    CHECK(strlen(matmul_last_error(ctx)) > 0, "no description after NO_KERNEL");
+    CHECK_STATUS(matmul_select(ctx, "no_such_mode", 64), MATMUL_ERR_MODE);
+
+    CHECK_STATUS(matmul_select(ctx, "avx", 32), MATMUL_OK);
+    CHECK(strlen(matmul_last_error(ctx)) == 0, "description left after a successful select");
+    CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n - 1, B, n, C, n), MATMUL_ERR_ARG);
+    CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n, B, n, C, n), MATMUL_OK);
+
+    /* A streaming leaf would evict the temporaries strassen combines again */
+    CHECK_STATUS(matmul_set_strassen(ctx, 16, 1, "avx_nt"), MATMUL_OK);
+    CHECK_STATUS(matmul_select(ctx, "strassen", 32), MATMUL_ERR_MODE);
+    matmul_destroy(ctx);
+
+    /* steal distributes tiles between threads, so one thread cannot run it */
+    CHECK_STATUS(matmul_create(1, 0, &ctx), MATMUL_OK);
+    if (ctx) {
+        CHECK_STATUS(matmul_set_schedule(ctx, "steal"), MATMUL_OK);
+        CHECK_STATUS(matmul_select(ctx, "avx", 32), MATMUL_OK);
+        CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n, B, n, C, n), MATMUL_ERR_MODE);
+        CHECK_STATUS(matmul_counters_begin(ctx), MATMUL_ERR_MODE);
+        matmul_destroy(ctx);
+    }
+    free(A); free(B); free(C);
+}
+
+/* Counters are optional: without PAPI the context is refused with MATMUL_ERR_COUNTERS */
+static void test_counters(void) {
+    const int n = 96;
+    double *A = alloc_filled((size_t)n * n, 12), *B = alloc_filled((size_t)n * n, 13);
+    double *C = alloc_filled((size_t)n * n, 14);
+    matmul_ctx *ctx = NULL;
+    const matmul_status st = matmul_create(1, MATMUL_COUNTERS, &ctx);
+    if (st == MATMUL_ERR_COUNTERS) {
+        printf("[api_test] PAPI unavailable, counter checks skipped\n");
+    } else {
+        CHECK(st == MATMUL_OK && ctx, "matmul_create with counters returned '%s'", matmul_status_string(st));
+    }
+    if (ctx) {
+        CHECK_STATUS(matmul_select(ctx, "avx", 32), MATMUL_OK);
+        CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n, B, n, C, n), MATMUL_OK);
+        const int count = matmul_counter_count(ctx);
+        for (int i = 0; i < count; ++i) CHECK(matmul_counter_name(ctx, i) != NULL, "counter %d has no name", i);
+        CHECK(matmul_counter_name(ctx, count) == NULL, "name past the last counter");
+
+        CHECK_STATUS(matmul_counters_end(ctx), MATMUL_ERR_ARG);
+        CHECK_STATUS(matmul_counters_begin(ctx), MATMUL_OK);
+        CHECK_STATUS(matmul_counters_begin(ctx), MATMUL_ERR_ARG);
+        CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n, B, n, C, n), MATMUL_OK);
+        CHECK_STATUS(matmul_dgemm(ctx, n, n, n, A, n, B, n, C, n), MATMUL_OK);
+        CHECK_STATUS(matmul_counters_end(ctx), MATMUL_OK);
+        CHECK(matmul_counter_count(ctx) == count, "session measured %d counters, a single call %d",
+              matmul_counter_count(ctx), count);
+        matmul_destroy(ctx);
+    }
+    free(A); free(B); free(C);
+}
+
+int main(void) {
+    CHECK(matmul_api_version() == MATMUL_API_VERSION, "library version %d, header version %d",
+          matmul_api_version(), MATMUL_API_VERSION);
+
+    test_dgemm("avx", 64, 1);
+    test_dgemm("scalar", 48, 1);
+    test_dgemm("avx_packed", 64, 1);
+    test_dgemm("avx", 32, 3);
+    test_dgemm("blas_whole", 0, 1);
+    test_dgemm("strassen", 32, 1);
+    test_dgemm("morton", 32, 1);
+
+    test_batch("avx", 32, 1);
+    test_batch("avx", 32, 3);
+    test_batch("strassen", 32, 2);
+
+    test_errors();
+    test_counters();
+
+    if (failures) {
+        fprintf(stderr, "[api_test] %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("[api_test] all checks passed\n");
+    return 0;
+}